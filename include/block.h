@@ -1,16 +1,45 @@
 #ifndef BLOCK_H
 #define BLOCK_H
+#include <array>
+#include <initializer_list>
 #include <iostream>
 #include <vector>
 #include <utility>
 #include <string>
+#include "blockPool.h"
 #include "tile.h"
 #include "player.h"
 
 using namespace std;
 
-class Block : public std::enable_shared_from_this<Block>{
+// Coords of the Tiles of a Block, kept in place since a Block has at most four,
+// so that making, moving and rotating Blocks never allocates
+class BlockCoords {
+    static constexpr int MAX_TILES = 4;
+    std::array<std::pair<int, int>, MAX_TILES> items;
+    int count = 0;
+
+  public:
+    BlockCoords() = default;
+    BlockCoords(std::initializer_list<std::pair<int, int>> coords);
+    void emplace_back(int x, int y) { items[count++] = {x, y}; }
+    const std::pair<int, int> *begin() const { return items.data(); }
+    const std::pair<int, int> *end() const { return items.data() + count; }
+    size_t size() const { return count; }
+    const std::pair<int, int> &operator[](size_t i) const { return items[i]; }
+    // for the searches keyed on the coords of a Block
+    operator std::vector<std::pair<int, int>>() const { return {begin(), end()}; }
+};
+
+// Blocks are made in a BlockPool, which destroys them once nothing refers to
+// them anymore (see BlockRef)
+class Block {
+    friend class BlockPool;
+
   protected:
+    // the Block's own slot, which its Tiles refer to
+    BlockPool *pool = nullptr;
+    uint32_t handle = 0;
     // Char that the Tiles will be made of
     char tileSymbol;
     // Level that the Block originated from
@@ -18,7 +47,7 @@ class Block : public std::enable_shared_from_this<Block>{
     // Pointer to the player so that it can update the score
     Player *player;
     // Vector of pairs to store the relative coords of the Tiles forming the Block
-    std::vector<std::pair<int, int>> coords;
+    BlockCoords coords;
     // Keep track of the following corners to adjust the rotations
     std::pair<int, int> bottomLeft;
     std::pair<int, int> bottomRight;
@@ -26,18 +55,21 @@ class Block : public std::enable_shared_from_this<Block>{
     std::pair<int, int> topRight;
   public:
     friend class board;
-    std::vector<std::pair<int, int>> getCoords() const;
+    const BlockCoords &getCoords() const;
     virtual ~Block() = 0;
     virtual Tile getBlockTile() = 0; // THIS SHOULD ONLY BE CALLED WHEN PLACING A TILE ON THE BOARD
+    // Copy of the Block in its current position, made in 'pool', for searches
+    // that explore positions without moving the actual Block
+    virtual BlockRef clone(BlockPool &pool) const = 0;
     char getBlockSymbol();
     
     // Get the new coords when rotating (give "CW" or "CCW")
-    virtual std::vector<std::pair<int, int>> computeRotatedCoords(string dir) const;
+    virtual BlockCoords computeRotatedCoords(string dir) const;
     // Actually rotate the block
     void rotate(string dir);
 
     // Get the new coords when moving (give "l", "r", or "d")
-    virtual std::vector<std::pair<int, int>> computeMovedCoords(string dir) const;
+    virtual BlockCoords computeMovedCoords(string dir) const;
     // Actually move the block
     void move(string dir);
     int getOrigLvl();
@@ -49,8 +81,9 @@ class OBlock : public Block {
   public:
     OBlock(int origLvl, Player *player);
     // Override because rotation on OBlock does nothing
-    std::vector<std::pair<int, int>> computeRotatedCoords(string dir) const override;
+    BlockCoords computeRotatedCoords(string dir) const override;
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~OBlock() override;
 };
 
@@ -59,6 +92,7 @@ class IBlock : public Block {
   public:
     IBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~IBlock() override;
 };
 
@@ -67,6 +101,7 @@ class SBlock : public Block {
   public:
     SBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~SBlock() override;
 };
 
@@ -75,6 +110,7 @@ class ZBlock : public Block {
   public:
     ZBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~ZBlock() override;
 };
 
@@ -83,6 +119,7 @@ class JBlock : public Block {
   public:
     JBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~JBlock() override;
 };
 
@@ -91,6 +128,7 @@ class LBlock : public Block {
   public:
     LBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~LBlock() override;
 };
 
@@ -99,6 +137,7 @@ class TBlock : public Block {
   public:
     TBlock(int origLvl, Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~TBlock() override;
 };
 
@@ -107,6 +146,7 @@ class StarBlock : public Block {
   public:
     StarBlock(Player *player);
     Tile getBlockTile() override;
+    BlockRef clone(BlockPool &pool) const override;
     ~StarBlock() override;
 };
 
@@ -0,0 +1,125 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+class Block;
+class BlockPool;
+
+// Counted reference to a Block of a BlockPool, used like a std::shared_ptr
+// but without any control block or atomic count: it is a pool and a small
+// integer handle, and the count lives in the Block's slot. The Block is
+// destroyed (scoring it for its Player, see Block's dtors), and its slot
+// reused, once its last reference goes, be it the Tile of its last cell
+// cleared or a Board's current or next Block.
+class BlockRef {
+    BlockPool *pool = nullptr;
+    // 0 for no Block
+    uint32_t handle = 0;
+
+    public:
+        BlockRef() = default;
+        BlockRef(std::nullptr_t) {}
+        BlockRef(BlockPool *pool, uint32_t handle);
+        BlockRef(const BlockRef &other);
+        BlockRef(BlockRef &&other) noexcept;
+        BlockRef &operator=(BlockRef other) noexcept;
+        ~BlockRef();
+
+        Block *get() const;
+        Block *operator->() const { return get(); }
+        Block &operator*() const { return *get(); }
+        explicit operator bool() const { return handle != 0; }
+        uint32_t getHandle() const { return handle; }
+};
+
+// Arena the Blocks of a Game (or a search) are created in. Slots are
+// allocated a chunk at a time and never given back, only reused, so once the
+// pool has as many slots as there are ever Blocks alive at once, creating a
+// Block allocates nothing. Only used by one thread at a time.
+class BlockPool {
+    friend class BlockRef;
+
+    static constexpr size_t SLOT_SIZE = 128;
+    static constexpr size_t CHUNK_SLOTS = 64;
+
+    struct Slot {
+        alignas(std::max_align_t) unsigned char storage[SLOT_SIZE];
+        Block *block;
+        uint32_t refs;
+        // next free slot while this one is free
+        uint32_t nextFree;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    uint32_t freeList = 0;
+    uint64_t created = 0;
+
+    Slot &slot(uint32_t handle) { return chunks[(handle - 1) / CHUNK_SLOTS][(handle - 1) % CHUNK_SLOTS]; }
+    // a free slot's handle, allocating a chunk if there is none
+    uint32_t acquire();
+    void retain(uint32_t handle) { ++slot(handle).refs; }
+    void release(uint32_t handle) {
+        if (--slot(handle).refs == 0) destroy(handle);
+    }
+    void destroy(uint32_t handle);
+
+    public:
+        BlockPool() = default;
+        BlockPool(const BlockPool &) = delete;
+        BlockPool &operator=(const BlockPool &) = delete;
+
+        // a new 'T' (a kind of Block) made from 'args'
+        template<typename T, typename... Args>
+        BlockRef make(Args &&...args) {
+            static_assert(sizeof(T) <= SLOT_SIZE && alignof(T) <= alignof(std::max_align_t),
+                          "the Block does not fit in a slot");
+
+            uint32_t handle = acquire();
+            Slot &s = slot(handle);
+            T *block = new (s.storage) T(std::forward<Args>(args)...);
+
+            block->pool = this;
+            block->handle = handle;
+            s.block = block;
+            s.refs = 0;
+            ++created;
+
+            return BlockRef{this, handle};
+        }
+
+        // Blocks ever made, slots there are room for, and the times more room
+        // was allocated (which stops growing once the pool is warm)
+        uint64_t blocksCreated() const { return created; }
+        size_t capacity() const { return chunks.size() * CHUNK_SLOTS; }
+        size_t chunkAllocations() const { return chunks.size(); }
+};
+
+inline BlockRef::BlockRef(BlockPool *pool, uint32_t handle): pool{pool}, handle{handle} {
+    if (handle) pool->retain(handle);
+}
+
+inline BlockRef::BlockRef(const BlockRef &other): pool{other.pool}, handle{other.handle} {
+    if (handle) pool->retain(handle);
+}
+
+inline BlockRef::BlockRef(BlockRef &&other) noexcept:
+    pool{std::exchange(other.pool, nullptr)}, handle{std::exchange(other.handle, 0)} {}
+
+inline BlockRef &BlockRef::operator=(BlockRef other) noexcept {
+    std::swap(pool, other.pool);
+    std::swap(handle, other.handle);
+    return *this;
+}
+
+inline BlockRef::~BlockRef() {
+    if (handle) pool->release(handle);
+}
+
+inline Block *BlockRef::get() const { return handle ? pool->slot(handle).block : nullptr; }
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef BLOCK_SEQUENCE_H
+#define BLOCK_SEQUENCE_H
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The Blocks of a sequence file, read once and never changed afterwards. The
+// Levels that follow a sequence only keep their position in it, so producing a
+// Block never touches the file again. Whitespace between Blocks is skipped, and
+// anything that is not one of the seven Blocks is left out and reported.
+// Sequences are normally obtained through 'load', which shares one copy of
+// each file between every Player and Game of the process.
+class BlockSequence {
+    std::string file;
+    std::vector<char> blocks;
+    // description of the first invalid character found, empty if there is none
+    std::string error;
+
+    public:
+        BlockSequence() = default;
+        explicit BlockSequence(const std::string &file);
+
+        // the sequence of 'file', read only the first time it is asked for or
+        // if the file was modified since. Safe to call from any thread.
+        static std::shared_ptr<const BlockSequence> load(const std::string &file);
+
+        const std::string &getFile() const;
+        const std::vector<char> &getBlocks() const;
+        size_t size() const;
+        bool empty() const;
+        // 'i'th Block, going back to the beginning after the last one, or 0 for
+        // an empty sequence
+        char at(size_t i) const;
+        bool isValid() const;
+        const std::string &getError() const;
+};
+
+#endif
@@ -1,31 +1,59 @@
 #ifndef BOARD_H
 #define BOARD_H
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
 #include "tile.h"
 #include "block.h"
+#include "boardDims.h"
+#include "boardFeatures.h"
+#include "rowMasks.h"
 
-class Board {
+// A Board of 'Rows' by 'Cols' Tiles. The size is part of the type, so every
+// loop over the Board has a fixed bound and the bitmasks are exactly as wide as
+// a row; each size is its own specialization (see the end of board.cc).
+template<int Rows, int Cols>
+class BasicBoard {
     friend class Game;
-    const int ROWS = 18, COLS = 11;
-    const int BLINDL = 2, BLINDR = 11, BLINDT = 2, BLINDB = 8;
-    std::vector<std::vector<Tile>> grid; // 2D vector representing the Board
-    std::shared_ptr<Block> currentBlock;
-    std::shared_ptr<Block> nextBlock;
+    friend class Reachability;
+    friend class Perft;
+    public:
+        using Dims = BoardDims<Rows, Cols>;
+        static constexpr int ROWS = Rows, COLS = Cols;
+
+    private:
+    std::array<std::array<Tile, Cols>, Rows> grid; // 2D array representing the Board
+    BlockRef currentBlock;
+    BlockRef nextBlock;
     bool isBlindBoard;
+    // Zobrist hash of the occupied Tiles, the current Block's included, kept
+    // up to date by 'setTile'
+    uint64_t hash;
+    // whether the current Block's Tiles are on the grid, where they are not
+    // settled yet
+    bool blockPlaced;
+    // Occupied Tiles as bitmasks, kept up to date by 'setTile'
+    BasicRowMasks<Rows> rowMasks;
+    // Features of the Board, only recomputed for the columns and rows that
+    // changed since they were last asked for
+    mutable BasicBoardFeatures<Rows, Cols> features;
+    mutable uint16_t dirtyCols;
+    mutable uint32_t dirtyRows;
 
     bool tryMoveBlock(string dir); // Check if a Block can move (dir is "l", "r" or "d")
     bool tryRotateBlock(string dir); // Check if a Block can rotate (dir is either "CW" or "CCW")
     void shiftDown(int i); //Shifts all blocks in rows above and including i downards by 1
+    void setTile(int row, int col, const Tile &tile); // Replace a Tile, updating the hash
     public:
-        Board(); // Constructor
+        BasicBoard(); // Constructor
         char charAt(int row, int col) const; // Get the char at a specific index
         Block *getNextBlock();
         
-        void setNewCurrentBlock(std::shared_ptr<Block> block); // Set the new currentBlock
-        void setNewNextBlock(std::shared_ptr<Block> block); // Set the new nextBlock
-        std::shared_ptr<Block> getBoardNextBlock();
+        void setNewCurrentBlock(BlockRef block); // Set the new currentBlock
+        void setNewNextBlock(BlockRef block); // Set the new nextBlock
+        BlockRef getBoardNextBlock();
 
         bool tryPlaceBlock(); // Check if a Block can be placed at starting position
         void placeBlock();
@@ -48,9 +76,23 @@ class Board {
         int clearFullRows(); // Clears full rows from the board and returns the number of cleared rows
         void clearBoard(); // Set all Tiles to blank Tiles
 
-        bool dropStarBlock(Player* player); // Drops a StarBlock down the middle. Returns false if can't be placed
+        bool dropStarBlock(BlockRef star); // Drops a StarBlock down the middle. Returns false if can't be placed
         void setBlind(const bool blind);
         bool isBlind();
+        // Hash of the settled Tiles on the Board (leaving out the current Block
+        // while it is on it), available without walking the grid
+        uint64_t getHash() const;
+        // Column heights, holes, row transitions and well depths of the Tiles
+        // on the Board (including the current Block while it is on it)
+        const BasicBoardFeatures<Rows, Cols> &getFeatures() const;
+        // Features the Board would have if the current Block was moved to
+        // 'coords' and settled there, clearing full rows, without changing the Board
+        BasicBoardFeatures<Rows, Cols> evaluatePlacement(const std::vector<std::pair<int, int>> &coords) const;
 };
 
+// the Board the game is played on
+using Board = BasicBoard<StandardDims::ROWS, StandardDims::COLS>;
+// a taller and wider Board for stress tests
+using WideBoard = BasicBoard<WideDims::ROWS, WideDims::COLS>;
+
 #endif
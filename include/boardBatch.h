@@ -0,0 +1,56 @@
+#ifndef BOARD_BATCH_H
+#define BOARD_BATCH_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "rowMasks.h"
+
+// Many Boards' row bitmasks packed side by side, so the same operation can run
+// on a whole vector register of Boards at once. Boards are stored in chunks of
+// 'LANES': row 'r' of the 16 Boards of a chunk are next to each other, which is
+// exactly one AVX2 register (or two SSE2 ones). The kernels are picked when the
+// program runs, depending on what the CPU supports, and all of them give the
+// same results as the scalar ones, which follow Board::clearFullRows exactly.
+class BoardBatch {
+    public:
+        enum class Kernels { Scalar, SSE2, AVX2 };
+        static constexpr int LANES = 16;
+
+    private:
+        struct alignas(32) Chunk {
+            uint16_t rows[MASK_ROWS][LANES];
+        };
+
+        std::vector<Chunk> chunks;
+        size_t count;
+        Kernels kernels;
+
+    public:
+        BoardBatch();
+
+        // best kernels supported by this CPU
+        static Kernels bestKernels();
+        static const char *kernelsName(Kernels k);
+        // forces a set of kernels (e.g. the scalar ones to compare against),
+        // falling back to the best supported one if 'k' is not supported
+        void useKernels(Kernels k);
+        Kernels getKernels() const;
+
+        size_t size() const;
+        void clear();
+        void push(const RowMasks &rows);
+        RowMasks get(size_t i) const;
+
+        // bit 'r' of each Board's result is set when its row 'r' is full
+        void fullRows(std::vector<uint32_t> &res) const;
+        // clears the full rows of every Board, like Board::clearFullRows, and
+        // gives the number of rows each Board cleared
+        void clearFullRows(std::vector<int> &res);
+        // height of each column of each Board, 0 for an empty column
+        void columnHeights(std::vector<std::array<uint8_t, MASK_COLS>> &res) const;
+        // number of empty Tiles with an occupied Tile above them, per Board
+        void holes(std::vector<int> &res) const;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef BOARD_DIMS_H
+#define BOARD_DIMS_H
+
+// Size of a Board and the rectangle of Tiles the blind special action hides
+// (columns BLIND_LEFT to BLIND_RIGHT and rows BLIND_TOP to BLIND_BOTTOM). The
+// Board and the observers drawing it both take them from here.
+template<int Rows, int Cols>
+struct BoardDims {
+    // each row is a 16-bit mask and the dirty rows of a Board a 32-bit one
+    static_assert(Cols > 4 && Cols <= 16, "a row must fit in a 16-bit mask");
+    static_assert(Rows > 8 && Rows < 32, "the rows must fit in a 32-bit mask");
+
+    static constexpr int ROWS = Rows, COLS = Cols;
+    static constexpr int BLIND_LEFT = 2, BLIND_RIGHT = Cols - 3;
+    static constexpr int BLIND_TOP = 2, BLIND_BOTTOM = Rows - 7;
+
+    static constexpr bool isBlinded(int row, int col) {
+        return col >= BLIND_LEFT && col <= BLIND_RIGHT && row >= BLIND_TOP && row <= BLIND_BOTTOM;
+    }
+};
+
+// the Board the game is played on
+using StandardDims = BoardDims<18, 11>;
+// a taller and wider Board for stress tests
+using WideDims = BoardDims<24, 16>;
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef BOARD_FEATURES_H
+#define BOARD_FEATURES_H
+#include <array>
+#include "rowMasks.h"
+
+// Features of a Board used to evaluate how good a position is. The per-column
+// and per-row values can each be updated on their own, so a Board only has to
+// redo the columns and rows that changed since it last computed them.
+template<int Rows, int Cols>
+struct BasicBoardFeatures {
+    using Masks = BasicRowMasks<Rows>;
+
+    // height of the highest Tile of each column, 0 for an empty column
+    std::array<int, Cols> heights;
+    // empty Tiles with an occupied Tile somewhere above them, per column
+    std::array<int, Cols> holes;
+    // changes between occupied and empty Tiles along each row, the walls
+    // counting as occupied
+    std::array<int, Rows> transitions;
+
+    // totals of the above
+    int aggregateHeight = 0, maxHeight = 0, totalHoles = 0, rowTransitions = 0;
+    // sum of the height differences between neighbouring columns
+    int bumpiness = 0;
+    // sum of how far each column is below both of its neighbours (the walls
+    // being as high as the Board)
+    int wellDepths = 0;
+    // rows cleared by the placement, only set by Board::evaluatePlacement
+    int linesCleared = 0;
+
+    void updateColumn(const Masks &rows, int col);
+    void updateRow(const Masks &rows, int row);
+    // recomputes the totals from the per-column and per-row values
+    void summarize();
+    static BasicBoardFeatures fromRows(const Masks &rows);
+
+    bool operator==(const BasicBoardFeatures &other) const = default;
+
+    // higher is better, weighing the height, lines cleared, holes and bumpiness
+    double score() const;
+};
+
+using BoardFeatures = BasicBoardFeatures<MASK_ROWS, MASK_COLS>;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+#include <string>
+#include <vector>
+
+// One command as the Game runs it: the full name of a built-in command (or
+// "bonus", or one of the Game's own, like the end of the input) and how many
+// times it is run
+struct Command {
+    std::string name;
+    int multiplier;
+};
+
+// what a line of input runs, in order: the command it names, or a macro's
+using Commands = std::vector<Command>;
+
+#endif
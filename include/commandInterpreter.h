@@ -1,33 +1,72 @@
 #ifndef COMMAND_INTERPRETER_H
 #define COMMAND_INTERPRETER_H
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "command.h"
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <sstream>
 
 using namespace std;
 
+struct ScriptOp;
+
 class CommandInterpreter {
     // Game* game;
     unordered_map<string, string> commands;
+    // the commands of each macro, by its text, split once when it is defined
+    unordered_map<string, Commands> macros;
     vector<string> builtinCommands;
+    // where the messages and prompts go, std::cout unless told otherwise
+    std::ostream* out;
 
     void renameCommand(string& commandName, string& newName);
-    bool createMacro();
-    bool isBuiltinCommand(string& command) const;
+    // reads the macro's name and commands from 'in'
+    bool createMacro(std::istream& in);
+    bool isBuiltinCommand(const string& command) const;
+    // what a line naming 'match' (a command's value) runs
+    Commands commandsFor(const string& match, int multiplier) const;
+    // a macro's text as its commands, e.g. "3left 2clockwise"
+    static Commands splitCommands(const string& text);
+    // Splits the first word of a command line into its multiplier and the
+    // command it names (empty if there is none), writing to 'out' what is wrong
+    // with it. Returns false if it is not a command, or names more than one.
+    bool lookupCommand(const string& first, int& multiplier, string& commandName, string& match,
+                       ostream& out) const;
+    // 'in' is where a macro is read from, the player's own input
+    Commands parseLine(const string& input, string& filename, bool bonus, std::istream& in);
+    // what 'parseSpecAct' gives for a line without its target: "blind",
+    // "heavy", the Block a 'force' names, or "" if it is no special action
+    static string matchSpecAct(const string& action);
+    // removes the Player number a special action may end with from 'input',
+    // returning it, or 0 if there is none
+    static int splitTarget(string& input);
 
    public:
     // CommandInterpreter(Game* game);
     CommandInterpreter();
     ~CommandInterpreter() = default;
 
-    string parseCommand(std::istream& in, string& filename, bool bonus);
-    std::string parseSpecAct(std::istream& in) const;
+    Commands parseCommand(std::istream& in, string& filename, bool bonus);
+    // 'target' is set to the Player (from 1) the special action names after
+    // it, or 0 if it names none
+    std::string parseSpecAct(std::istream& in, int& target) const;
+
+    // Resolves a line of a script file ahead of time, with the commands as they
+    // are now. 'error' is set if the line is neither a command nor a special action.
+    ScriptOp compileLine(const string& input, int line, string& error) const;
+    // gives what 'parseCommand' would have for the op's line, 'in' being the
+    // player's own input
+    Commands runOp(const ScriptOp& op, string& filename, bool bonus, std::istream& in);
+    // gives what 'parseSpecAct' would have for the op's line
+    std::string runSpecAct(const ScriptOp& op, int& target) const;
+    void setOutput(std::ostream& o);
+    // changes whenever a command is renamed or a macro defined
+    uint64_t commandsHash() const;
 };
 
 #endif
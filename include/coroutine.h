@@ -0,0 +1,44 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <ucontext.h>
+
+// A function run on its own stack, which can suspend itself anywhere (however
+// deep in its calls) and be resumed later from that exact point. This is what
+// lets code written to block, such as Game::play waiting for its next line of
+// input, be put aside while waiting and picked up again once there is input.
+// A Coroutine must always be resumed from the same thread.
+class Coroutine {
+    ucontext_t caller, context;
+    // the whole mapping, whose lowest page is left inaccessible so that
+    // overflowing the stack faults right away instead of overwriting memory
+    void *stack;
+    size_t stackSize, guardSize;
+    std::function<void()> body;
+    bool running, finished;
+    // thrown by the body, rethrown by 'resume'
+    std::exception_ptr error;
+
+    static void entry(unsigned int low, unsigned int high);
+
+    public:
+        // the stack is only reserved, pages are used as the body needs them, so
+        // it is as large as a thread's default one
+        Coroutine(std::function<void()> body, size_t stackSize = 8 * 1024 * 1024);
+        ~Coroutine();
+        Coroutine(const Coroutine &) = delete;
+        Coroutine &operator=(const Coroutine &) = delete;
+
+        // runs the body until it suspends or returns, returns false once it
+        // has returned
+        bool resume();
+        // only from inside the body, goes back to whoever called 'resume'
+        void suspend();
+        bool isFinished() const;
+        // whether the body is being run, i.e. 'suspend' may be called
+        bool isRunning() const;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frame.h"
+#include "observer.h"
+
+class Game;
+
+// Observer broadcasting what happens in a Game as a compact binary stream, for
+// spectators and logs to follow without ever reading a whole Board. After the
+// magic "BQEV" and a version byte, the stream is a list of records, each a
+// type byte, a length byte and that many bytes of payload (numbers being
+// little-endian, players counted from 0):
+//   FRAME    u32 number   ends the records of one notification of the Game
+//   KEY      player, level, u32 score, next Block, then the Board's ROWS * COLS
+//            cells row after row, all of it, on the first FRAME and every
+//            KEY_INTERVAL FRAMEs after, for readers joining late
+//   CELLS    player, then (row * COLS + col, cell) pairs of cells that changed
+//   SPAWN    player, Block, next Block
+//   CLEAR    player, rows cleared
+//   SCORE    player, u32 score, u32 high score
+//   LEVEL    player, level
+//   TURN     player on turn
+//   SPECIAL  player, target, then the special action as given
+//   WIN      player who won
+// Cells are shown as the Player sees them ('?' while blind, see
+// Game::getState). A reader skips any record of a type it does not know.
+//
+// Each notification is encoded once and appended with a single write to a log
+// in memory (a memfd). Every sink follows that log on its own thread, and has
+// the kernel copy what was appended straight from it (sendfile), so the Game
+// never waits on a sink, and the data is never copied in user space however
+// many sinks there are.
+class EventStream: public Observer {
+    public:
+        enum Type: uint8_t { FRAME = 1, KEY, CELLS, SPAWN, CLEAR, SCORE, LEVEL, TURN, SPECIAL, WIN };
+        static constexpr int KEY_INTERVAL = 256;
+
+    private:
+        // a sink's file or FIFO, opened on its thread since opening a FIFO
+        // waits for its reader
+        struct Sink {
+            std::string path;
+            std::thread thread;
+        };
+
+        Game *game;
+        int logFd;
+        // records of the notification being encoded
+        std::vector<uint8_t> pending;
+        // the Frame last broadcast and the one being encoded
+        Frame prev, curr;
+        uint32_t frames = 0;
+
+        // bytes in the log, only ever growing
+        std::atomic<uint64_t> size{0};
+        // changed with each write and to stop, the sinks wait on it
+        std::atomic<uint64_t> version{0};
+        std::atomic<bool> stopping{false};
+        std::vector<std::unique_ptr<Sink>> sinks;
+
+        void record(Type type, const uint8_t *payload, size_t length);
+        void record(Type type, std::initializer_list<uint8_t> payload);
+        static void putU32(uint8_t *out, uint32_t value);
+        void encodeKey(int player);
+        void encodeChanges(int player);
+        // appends 'pending' and an ending FRAME to the log
+        void flush();
+        void follow(Sink &sink);
+
+    public:
+        EventStream(Game *game);
+        // stops once every sink was sent the whole stream
+        ~EventStream();
+        EventStream(const EventStream &) = delete;
+        EventStream &operator=(const EventStream &) = delete;
+
+        // whether the log could be created
+        bool isOpen() const;
+        // sends the stream, from its start, to the file or FIFO at 'path'
+        void addSink(const std::string &path);
+
+        void notify() override;
+        void notifyWin() override;
+        const char *name() const override { return "EventStream"; }
+        void notifySpawn(int player, char block, char next) override;
+        void notifyClear(int player, int rows) override;
+        void notifySpecialAction(int player, int target, const std::string &action) override;
+};
+
+#endif
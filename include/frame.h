@@ -0,0 +1,56 @@
+#ifndef FRAME_H
+#define FRAME_H
+#include <array>
+#include <chrono>
+#include <vector>
+#include "boardDims.h"
+
+class Game;
+
+// Everything the displays show of a Game at one moment, copied out of it so it
+// can be drawn on another thread while the Game plays on
+struct Frame {
+    using Clock = std::chrono::steady_clock;
+    static constexpr int ROWS = StandardDims::ROWS, COLS = StandardDims::COLS;
+    // the bottom two rows of the 4x4 grid of the next Block, the only ones a
+    // Block ever fills there
+    static constexpr int NEXT_TOP = 2, NEXT_ROWS = 2, NEXT_COLS = 4;
+
+    int numPlayers = 0;
+    int turn = 0;
+    int hiScore = 0;
+    std::vector<int> levels, scores;
+    // each Player's Board as 'Game::getState' gives it, row after row
+    std::vector<std::array<char, ROWS * COLS>> cells;
+    // each Player's next Block, ' ' where it has no Tile
+    std::vector<std::array<char, NEXT_ROWS * NEXT_COLS>> next;
+    // how many times a Player won so far, and the last one who did
+    int wins = 0;
+    int winner = 0;
+    // whether the Frame was taken for the win itself, the Boards being those
+    // of the Frame before
+    bool won = false;
+    // when the Frame was copied out of the Game
+    Clock::time_point taken;
+
+    // copies 'game', reusing the Frame's storage once it has the Game's size
+    void capture(Game &game);
+
+    char cell(int player, int row, int col) const { return cells[player][row * COLS + col]; }
+    // 'row' from NEXT_TOP to NEXT_TOP + NEXT_ROWS - 1
+    char nextCell(int player, int row, int col) const {
+        return next[player][(row - NEXT_TOP) * NEXT_COLS + col];
+    }
+};
+
+// A display that draws Frames instead of reading the Game itself, which it
+// then can do on any thread
+class FrameRenderer {
+    public:
+        virtual void render(const Frame &frame) = 0;
+        // the win of 'frame.winner'
+        virtual void renderWin(const Frame &frame) = 0;
+        virtual ~FrameRenderer() = default;
+};
+
+#endif
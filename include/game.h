@@ -1,15 +1,20 @@
 #ifndef GAME_H
 #define GAME_H
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <sstream>
 
 #include "board.h"
 #include "commandInterpreter.h"
+#include "coroutine.h"
 #include "observer.h"
 #include "player.h"
+#include "random.h"
+#include "script.h"
 #include "tile.h"
 
 class Observer;  // forward declaration
@@ -23,12 +28,18 @@ class Subject {
     void detach(Observer *o);
     void notifyObservers();
     void notifyWin();
+    void notifySpawn(int player, char block, char next);
+    void notifyClear(int player, int rows);
+    void notifySpecialAction(int player, int target, const std::string &action);
     virtual char getState(int player, int row, int col) const = 0;
     virtual ~Subject() = default;
 };
 
 class Game : public Subject {
     const std::string sEOF = "EOF";
+    // given by 'getCommand' instead of a command when gravity (see 'tick') is
+    // due, which no command can be as it has a space
+    const std::string sGravity = "gravity tick";
     // clearing more than 'SPECIAL_ACTION_THRES' rows allows the current player
     // to pick at least one special action
     const int SPECIAL_ACTION_THRES = 1;
@@ -38,34 +49,121 @@ class Game : public Subject {
     // one which Heavy applies
     const int HEAVY_LVL_DOWN = 1;
     const int HEAVY_SPEC_ACT_DOWN = 2;
-    const int P0_IDX = 0, P1_IDX = 1;
+    const int P0_IDX = 0;
+    // number of Players, at least two
+    const int numPlayers;
     // flag that determines whether we should activate the enhancements
     bool bonus;
     // 'heavySpecAct' is true when the current board has the Heavy special action
     // applied to it
     bool heavySpecAct;
     int hiScore;
-    // update 'currPlayerIdx' using: currPlayerIdx = 1 - currPlayerIdx, like
-    // taking the NOT of a bit
+    // Players take turns in the order of their index, so update 'currPlayerIdx'
+    // using 'nextPlayer', which skips the Players who are out
     int currPlayerIdx;
-    std::unique_ptr<Player> p0, p1;
-    int consec_drop0, consec_drop1;
+    // what the random Levels of every Player draw from, seeded by the Game
+    Random random;
+    // everything a Player has is stored at their index, the Players never
+    // moving once created, since their Blocks point to them
+    std::vector<Player> players;
+    // where every Block of the Game is made, before the Boards so that it
+    // outlives the Blocks on them (and after the Players their dtors score)
+    BlockPool blocks;
+    std::vector<int> consecDrops;
+    // Players who lost while others are still playing, only possible with
+    // more than two Players
+    std::vector<bool> isOut;
+    int playersLeft;
+    // special actions picked against each Player, applied on their next turn
+    std::vector<std::vector<std::string>> pendingSpecActs;
     // raw pointer pointing to the current player, makes it easier to access the
     // actual Player object instead, and relies on 'currPlayerIdx' integer to
-    // switch between the two players easily
+    // switch between the players easily
     Player *currPlayerPointer;
-    std::unique_ptr<Board> board0, board1;
+    std::unique_ptr<Board[]> boards;
     std::unique_ptr<CommandInterpreter> ci;
-    // will be open on a file when the user(s) decide to give a text file
-    // containing a sequence of commands, and will be closed when either the file
-    // given has been read completely, or when there was no text file given to
-    // begin with
-    std::ifstream readFromSeq;
+    // where the Game's messages and prompts go, std::cout unless told otherwise
+    std::ostream *out;
+    // where a Player's commands come from
+    struct Source {
+        // the Player's input, std::cin unless told otherwise
+        std::istream *in;
+        // will be set when the user(s) decide to give a text file containing a
+        // sequence of commands, read and resolved in one go, and will be reset
+        // when either the file given has been played completely, or when there
+        // was no text file given to begin with
+        std::unique_ptr<Script> readFromSeq;
+        // whether 'in' is a file being replayed rather than typed
+        bool isFile = false;
+    };
+    // Players reading from the same input share the Source of the first of
+    // them (and so a sequence file given by any drives all of them), otherwise
+    // each has their own
+    std::vector<Source> sources;
+    std::vector<int> sourceIdx;
+
+    // Source of the current Player, or of 'player'
+    Source &source();
+    Source &source(int player);
+
+    // frames per second the Boards are shown at while replaying a file (see
+    // 'setReplayRendering'), when they were last shown, and whether a change
+    // to them was not shown since
+    int replayFps;
+    std::chrono::steady_clock::time_point lastShown;
+    bool unshown;
+    // whether the current Player's commands come from a file
+    bool replaying();
+    // shows the Boards to the Observers, unless replaying a file and they were
+    // shown too recently ('turnStart' when shown as a turn starts)
+    void show(bool turnStart = false);
+    // shows the Boards if a change to them was not shown
+    void showUnshown();
+
+    // Input given through 'feed', which suspends the Game (see 'step') when
+    // there is nothing left to read instead of waiting for more
+    class FedInput : public std::streambuf {
+        Game &game;
+        // guards 'pending', 'ended' and 'ticked', as input may be fed from
+        // another thread than the one stepping the Game
+        mutable std::mutex m;
+        std::string pending, current;
+        bool ended;
+        // whether gravity is due, however many ticks there were
+        bool ticked;
+        // characters of the last line appended so far, past MAX_LINE of
+        // which the rest of the line is dropped
+        size_t lineLength;
+
+       protected:
+        int_type underflow() override;
+
+       public:
+        // longest line kept, far more than any command needs, so a client
+        // cannot make the Game hold (or parse) lines of any length
+        static constexpr size_t MAX_LINE = 4096;
+
+        FedInput(Game &game);
+        void append(const char *data, size_t size);
+        void end();
+        bool hasInput() const;
+        void tick();
+        // returns whether gravity was due, and makes it no longer due
+        bool takeTick();
+        // whether a whole line (or the end of the input) can be read
+        bool hasLine() const;
+    };
+    FedInput fedBuf;
+    std::istream fedIn;
+    // runs 'play' for 'step', created by the first 'step'
+    std::unique_ptr<Coroutine> turns;
 
     // increments the current Player's points, and updates the hi score if needed
     void getPoints(int rowsCleared);
     // private methods, mechanics to allow our game to run
     void updateHiScore();
+    // next Player after 'idx' who is still playing
+    int nextPlayer(int idx) const;
     // Switches Player turn. Before switching also determines whether the current
     // Player has lost upon trying to place their next Block onto the Board (true
     // if they lose, false if the initial Block placement is successful)
@@ -78,15 +176,26 @@ class Game : public Subject {
     // Returns TRUE when the turn ended successfully, meaning it is now the next
     // player's turn, and FALSE when EOF is reached. Directly mutates the argument
     // to indicate how many rows the player has cleared on their turn. Also
-    // indicates whether the player has lost upon having special actions applied.
-    bool playTurn(int &currTurnRowsCleared, bool &currPlayerLose, std::vector<std::string> specActs, bool& gameReset);
+    // indicates whether the player has lost upon having the special actions
+    // picked against them applied, which is done first.
+    bool playTurn(int &currTurnRowsCleared, bool &currPlayerLose, bool& gameReset);
+    // 'player' lost: with more than two Players left they are out and the
+    // others play on (returns true), otherwise the Game is won (returns false)
+    bool eliminate(int player);
     // this method is executed at the very beginning of the game to set up the
     // Boards' initial Blocks properly
     void gameInit();
     // this method is called to update the opponent/next Player's Block, and
     // checks whether it fits onto their Board
     bool updateBlock();
-    std::string getCommand(std::string& filename);
+    Commands getCommand(std::string& filename);
+    // whether 'commands' is the one command 'name', e.g. 'sEOF'
+    static bool isOnly(const Commands& commands, const std::string& name);
+    // while stepped, waits for the current Player's next line as 'feed' gives
+    // it, returning true if gravity is due first
+    bool waitForCommand();
+    // reads the script file given with 'sequence', reporting its invalid lines
+    void openSequence(const std::string& filename);
     bool updateBoard(std::string command, int multiplier, bool& currPlayerLose);
     // Given a command, we check whether we must apply any of the Heavy properties
     // (applies them if needed). Returns True if the current Player's turn has ended,
@@ -108,10 +217,13 @@ class Game : public Subject {
     // without needing the 'drop' command being executed. This is used for both
     // the Level and Special Action 'Heavy'
     bool applyHeavy();
-    // prompting the player to choose special action(s) depending on 'rowsCleared'
-    std::vector<std::string> promptForSpecAct(int rowsCleared, bool& isEOF);
-    // checking for duplicates for the chosen special actions
-    void checkDupSpecAct(std::vector<std::string> &specActs, std::string toAdd);
+    // prompting 'player' to choose special action(s) depending on 'rowsCleared',
+    // adding them to 'pendingSpecActs' of the Players they target, by default
+    // the next Player
+    void promptForSpecAct(int player, int rowsCleared, bool& isEOF);
+    // checking for duplicates for the chosen special actions, returns whether
+    // 'toAdd' was added
+    bool checkDupSpecAct(std::vector<std::string> &specActs, std::string toAdd);
     // Methods relating to the special actions, adding them to a Board and
     // clearing the special actions upon a turn end, as all special actions
     // currently only last one turn for a player. Returns true if adding the
@@ -126,15 +238,20 @@ class Game : public Subject {
     // player(s) for whether they wish to restart the game
     bool checkForGameReset();
     // Creating Block objects depending on which Block we want, and returning it.
-    std::shared_ptr<Block> createBlock(const char block);
+    BlockRef createBlock(const char block);
 
    public:
     Game(bool bonus, int seed, string seq0, string seq1, int startLevel);  // Ctor
+    // a Game of 'seqs.size()' Players, Player 'p' using the sequence file 'seqs[p]'
+    Game(bool bonus, int seed, const std::vector<std::string> &seqs, int startLevel);
 
     // Accessors
     int getLevel(int player) const;
     int getScore(int player) const;
     int getHiScore() const;
+    int getNumPlayers() const;
+    // whether 'player' lost while others are still playing
+    bool isPlayerOut(int player) const;
 
     int getPlayerTurn() const;
     Player *getCurrentPlayer() const;
@@ -142,12 +259,53 @@ class Game : public Subject {
 
     char getState(int board, int row, int col) const override;
 
+    // sends the Game's messages and prompts to 'o' instead of std::cout (the
+    // Boards are shown by the Observers, which have their own output)
+    void setOutput(std::ostream &o);
+    // makes 'player' (from 0) read their commands from 'in' instead of std::cin
+    void setInput(int player, std::istream &in);
+    // tells the Game the input of 'player' is a file being replayed, to which
+    // 'setReplayRendering' then applies as it does to sequence files
+    void setFileInput(int player);
+    // While commands come from a file (the 'sequence' command, or an input set
+    // with 'setFileInput'), the Boards are shown at most 'framesPerSecond'
+    // times a second, or only as each turn starts if 0. The last Boards before
+    // the file ends, a win or the end of the Game are always shown. Negative
+    // (the default) shows every change, as when the commands are typed.
+    void setReplayRendering(int framesPerSecond);
+
     Block *getNextBlock(int p);  // For textObserver to fetch the next Block
+    // plays the whole Game, waiting for input whenever it needs some
     void play();
+
+    // The Game can also be driven without ever waiting: input is given with
+    // 'feed' as it arrives, and 'step' plays as far as that input goes, then
+    // returns, to carry on from that same point on the next 'step'. Once 'step'
+    // was used, all Players only read what was fed. 'feed', 'feedInput' and
+    // 'endInput' may be called from another thread than 'step'.
+    enum class Status { NeedsInput, Finished };
+    // gives one line of commands (or a special action, etc.) to the Game
+    void feed(const std::string &command);
+    // gives raw input, which may hold several lines or only part of one
+    void feedInput(const char *data, size_t size);
+    // nothing else will be fed, the Game then ends as it does at EOF
+    void endInput();
+    // whether the Game has not yet seen all that was fed (or the end of it)
+    bool hasInput() const;
+    // one tick of gravity: the next time the Game waits for a command, the
+    // current Block falls a row instead, landing (which ends the turn, same as
+    // 'drop') if it cannot. Ticks that come while the Game is not waiting for
+    // a command make the Block fall once it does.
+    void tick();
+    // plays until the Game needs input that was not fed yet, or is over
+    Status step();
     void restart();
 
-    // for the observers to determine whether a specific board is blind, 0 means
-    // board0, 1 means board1
+    // Blocks made so far, and the pool's growth, which stops once it is warm
+    const BlockPool &getBlockPool() const;
+
+    // for the observers to determine whether a specific board is blind, 'board'
+    // being the index of its Player
     bool isBoardBlind(int board);
 };
 
@@ -0,0 +1,82 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gameSession.h"
+
+// Hosts one GameSession per client connected to a Unix domain socket. A single
+// event loop (epoll) accepts the clients, reads their commands and writes back
+// what their Game prints, while a small pool of workers runs the Games. Each
+// session always runs on the same worker, which its Coroutine requires.
+class GameServer {
+    struct Client {
+        int fd;
+        int worker;
+        std::unique_ptr<GameSession> session;
+        // what the Game printed and the client was not sent yet, and whether
+        // the connection closes once it is sent
+        std::string outbox;
+        bool closing;
+        bool reading;
+        // whether the Client is in 'ready', so it is never in it twice (a
+        // second flush could find it already closed and freed by the first)
+        bool queued;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex m;
+        std::condition_variable cv;
+        std::deque<Client *> queue;
+    };
+
+    std::string path;
+    // options of the Games
+    bool bonus;
+    // seed of the next session, each one getting the one after the last
+    int nextSeed;
+    // sequence file of each Player
+    std::vector<std::string> seqs;
+    int startLevel;
+
+    int listenFd, epollFd, wakeFd;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::map<int, std::unique_ptr<Client>> clients;
+    int nextWorker;
+    bool stopping;
+
+    // guards the outboxes and closing and queued flags the workers fill, and
+    // the list of Clients that have something new for the event loop
+    std::mutex outMutex;
+    std::vector<Client *> ready;
+
+    void accept();
+    void readFrom(Client *client);
+    void flush(Client *client);
+    void close(Client *client);
+    void schedule(Client *client);
+    void work(Worker &worker);
+
+    public:
+        // the sessions are seeded with 'seed', 'seed' + 1 and so on, in the
+        // order the clients connect
+        GameServer(const std::string &path, int numWorkers, bool bonus, int seed,
+                   const std::vector<std::string> &seqs, int startLevel);
+        ~GameServer();
+        // serves clients until the process is stopped, returns false if the
+        // socket could not be set up
+        bool run();
+
+        // Local stand-in for a player: sends standard input to the server at
+        // 'path' and prints everything the server sends back. Returns false if
+        // it could not connect.
+        static bool client(const std::string &path);
+};
+
+#endif
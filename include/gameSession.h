@@ -0,0 +1,51 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "game.h"
+#include "textObserver.h"
+
+// One Game hosted by the GameServer for one client, every Player reading from
+// the client's commands. The Game is driven with Game::step, so it is set aside
+// whenever it waits for the client instead of blocking a worker, and a few
+// threads can run any number of sessions. Everything the Game prints is
+// collected and handed back by 'run'.
+class GameSession {
+    // guards 'scheduled', which the server's event loop sets while a worker
+    // may be running the session
+    std::mutex m;
+    // whether the session is waiting for a worker or being run by one
+    bool scheduled;
+    bool finished;
+
+    std::stringbuf outBuf;
+    std::ostream out;
+    std::unique_ptr<Game> game;
+    std::unique_ptr<TextObserver> textObs;
+
+    // returns true if the session must now be given to a worker
+    bool wake();
+
+    public:
+        // 'seed' is the session's own, its random Blocks not depending on
+        // what any other session does
+        GameSession(bool bonus, int seed, const std::vector<std::string> &seqs, int startLevel);
+
+        // Both are called by the event loop as the client sends data or closes
+        // its side, and return true if the session must now be given to a worker
+        // (false if it already is waiting for one or running)
+        bool feed(const char *data, size_t size);
+        bool endInput();
+        // runs the Game until it waits for input or ends, returning what it printed
+        std::string run();
+        // after 'run', returns true if input came in while running, in which
+        // case the session must run again, and otherwise marks it as idle
+        bool runAgain();
+        bool isFinished() const;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef _GRAPHICOBSERVER__H_
 #define _GRAPHICOBSERVER__H_
 #include "observer.h"
+#include "frame.h"
 #include "game.h"
 #include "board.h"
 #include "window.h"
@@ -8,51 +9,60 @@
 #include <vector>
 #include <memory>
 
-// Graphic observer
-class GraphicObserver: public Observer {
-    const int ROWS = 18, COLS = 11;
+// Graphic observer, showing the Boards of all the Players side by side.
+// Attached to the Game it draws as soon as notified; otherwise it can be given
+// Frames to draw (on another thread, see RenderThread).
+class GraphicObserver: public Observer, public FrameRenderer {
+    static constexpr int ROWS = StandardDims::ROWS, COLS = StandardDims::COLS;
     const int NEXTROWS = 4, NEXTCOLS = 4;
 
-    const int BLINDL = 2, BLINDR = 8, BLINDT = 2, BLINDB = 11;
-    const int WINDOW_WIDTH = 28;
     const int WINDOW_HEIGHT = 31;
+    // How many tiles each Player's Board (and everything above and below it)
+    // is shifted from the previous Player's
+    const int PLAYER_WIDTH = 15;
+    // Window width in tiles, which depends on the number of Players
+    int windowWidth;
 
-    const int GRID1LEFT = 1; // How many tiles Grid1 is shifted left
-    const int GRID2LEFT = 16; // How many tiles Grid2 is shifted
+    const int GRIDLEFT = 1; // How many tiles the first Grid is shifted left
     const int GRIDTOP = 6;
 
-    const int NEXT1LEFT = 1;
-    const int NEXT2LEFT = 16;
+    const int NEXTLEFT = 1;
     const int NEXTGRIDTOP = 25;
-    const int P0_IDX = 0, P1_IDX = 1;
 
+    int numPlayers;
     int prevPlayerIdx = 0;
     int prevHighScore = 0;
-    int p0PrevLevel = 0;
-    int p1PrevLevel = 0;
-    int p0PrevScore = 0;
-    int p1PrevScore = 0;
+    std::vector<int> prevLevels;
+    std::vector<int> prevScores;
 
 
     // Window for this Observer
     std::unique_ptr<Xwindow> window = nullptr;
     // Pointer to the Game subject
     Game *game;
-    // Char version of the grids to check what needs to be redrawn
-    std::vector<std::vector<char>> charGrid1;
-    std::vector<std::vector<char>> charGrid2;
+    // the Game as last notified, kept to reuse its storage
+    Frame frame;
+    // Char version of each Player's grid to check what needs to be redrawn
+    std::vector<std::vector<std::vector<char>>> charGrids;
 
-    // Char version of the grid for next block (4x4 grid), but we will only loop the bottom half
-    std::vector<std::vector<char>> nextGrid1;
-    std::vector<std::vector<char>> nextGrid2;
+    // Char version of each Player's grid for next block (4x4 grid), but we will
+    // only loop the bottom half
+    std::vector<std::vector<std::vector<char>>> nextGrids;
 
     int getColourForBlock(char c);
-    void print();
+    // x of the left of the Player's Board and labels, in pixels
+    int playerLeft(int player) const;
+    void printNext(const Frame &frame, int player, int i);
 
     public:
         GraphicObserver(Game *game); // Ctor
+        // the window the Boards are drawn on
+        const Xwindow &getWindow() const;
         void notify() override;
         void notifyWin() override;
+        const char *name() const override { return "GraphicObserver"; }
+        void render(const Frame &frame) override;
+        void renderWin(const Frame &frame) override;
         ~GraphicObserver() = default;
 };
 
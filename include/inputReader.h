@@ -0,0 +1,67 @@
+#ifndef INPUT_READER_H
+#define INPUT_READER_H
+#include <atomic>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include "spscQueue.h"
+
+// Reads a file descriptor on its own thread, handing what it reads to the game
+// thread through a lock-free ring, so waiting on (or copying from) the input
+// overlaps with running the game. The game thread reads it as a regular
+// stream, either through 'stream()' or by making an existing stream such as
+// std::cin read from it. Commands are still parsed on the game thread, since
+// what a line means depends on the renames, macros and enhancements so far.
+class InputReader {
+    static constexpr size_t CHUNKS = 64;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // stream buffer over the chunks of the ring, an empty chunk meaning the
+    // end of the input
+    class Buffer: public std::streambuf {
+        SpscQueue<std::string, CHUNKS> &chunks;
+        std::string current;
+        bool ended;
+
+        protected:
+            int_type underflow() override;
+
+        public:
+            Buffer(SpscQueue<std::string, CHUNKS> &chunks);
+    };
+
+    int fd;
+    // whether 'fd' was opened by this InputReader, and must be closed by it
+    bool ownsFd;
+    // written to in order to stop the reading thread
+    int wakeFds[2];
+    SpscQueue<std::string, CHUNKS> chunks;
+    Buffer buffer;
+    std::istream in;
+    std::thread reader;
+    std::atomic<bool> finished;
+    // stream whose buffer was replaced by 'replace', and its own buffer
+    std::istream *replaced;
+    std::streambuf *original;
+
+    void readLoop();
+
+    public:
+        InputReader(int fd);
+        // reads the file at 'path', which may also be a FIFO that has no
+        // writer yet, or /dev/fd/N for an inherited file descriptor
+        InputReader(const std::string &path);
+        // stops the reading thread, and gives back its buffer to the replaced stream
+        ~InputReader();
+        InputReader(const InputReader &) = delete;
+        InputReader &operator=(const InputReader &) = delete;
+
+        // false if the file could not be opened, in which case it reads as empty
+        bool isOpen() const;
+        std::istream &stream();
+        // makes 's' read from this InputReader until it is destroyed
+        void replace(std::istream &s);
+};
+
+#endif
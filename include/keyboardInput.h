@@ -0,0 +1,65 @@
+#ifndef KEYBOARD_INPUT_H
+#define KEYBOARD_INPUT_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "spscQueue.h"
+
+class Xwindow;
+// Xlib's Display, without including Xlib (whose macros, such as 'Status' and
+// 'KeyPress', clash with names of the game)
+struct _XDisplay;
+
+// Reads the key presses of the graphical window on its own thread, over its own
+// connection to the X server so that it never waits on the drawing. Each key
+// that stands for a command is handed over through a lock-free ring the moment
+// it is read, without waiting for a whole line, and 'fd()' becomes readable:
+//   arrows left, right and down   left, right, down
+//   arrow up or x                 clockwise
+//   z                             counterclockwise
+//   space                         drop
+// The keys give the commands' built-in names, so they keep working whatever
+// the commands were renamed to only if the built-in names are still there.
+class KeyboardInput {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Press {
+            std::string command;
+            // when the event thread read the key from the X server
+            Clock::time_point read;
+        };
+
+    private:
+        static constexpr size_t CAPACITY = 256;
+
+        _XDisplay *display;
+        unsigned long window;
+        // 'wakeFd' tells the consumer there are presses, 'stopFd' stops the thread
+        int wakeFd, stopFd;
+        SpscQueue<Press, CAPACITY> presses;
+        std::thread events;
+        // presses lost because the consumer let the ring fill up
+        std::atomic<uint64_t> dropped;
+
+        static const char *commandFor(unsigned long keysym);
+        void eventLoop();
+
+    public:
+        KeyboardInput(const Xwindow &window);
+        ~KeyboardInput();
+        KeyboardInput(const KeyboardInput &) = delete;
+        KeyboardInput &operator=(const KeyboardInput &) = delete;
+
+        // false if the X server or the event thread could not be set up
+        bool isOpen() const;
+        // readable while there are presses to pop (an eventfd)
+        int fd() const;
+        // consumer only, returns false if there is no press left
+        bool pop(Press &press);
+        uint64_t droppedPresses() const;
+};
+
+#endif
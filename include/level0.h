@@ -1,18 +1,20 @@
 #ifndef LEVEL0_H
 #define LEVEL0_H
 #include "level.h"
-#include <fstream>
-#include <string>
+#include "blockSequence.h"
+#include <cstddef>
+#include <memory>
 
 class Level0: public Level {
-    std::string seq;
-    std::ifstream f;
-
-    char readLine(std::ifstream& f);
+    std::shared_ptr<const BlockSequence> seq;
+    // index of the next Block in the sequence
+    size_t next;
 
     public:
-        Level0(const int l, std::string s);
+        Level0(const int l, std::shared_ptr<const BlockSequence> s);
         char produceBlock() override;
+        // starts the sequence over from its first Block
+        void restart();
         ~Level0() override;
 };
 
@@ -1,10 +1,18 @@
 #ifndef _OBSERVER_H_
 #define _OBSERVER_H_
+#include <string>
 
 class Observer {
  public:
   virtual void notify() = 0;
   virtual void notifyWin() = 0;
+  // what happened between two notifications, for the observers that want more
+  // than the Boards (players from 0, 'action' as the special action is given)
+  virtual void notifySpawn(int player, char block, char next) {}
+  virtual void notifyClear(int player, int rows) {}
+  virtual void notifySpecialAction(int player, int target, const std::string &action) {}
+  // what its notifications are called in a trace (a string literal)
+  virtual const char *name() const { return "Observer"; }
   virtual ~Observer() = default;
 };
 
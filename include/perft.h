@@ -0,0 +1,102 @@
+#ifndef PERFT_H
+#define PERFT_H
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "boardBatch.h"
+#include "player.h"
+#include "random.h"
+#include "reachability.h"
+#include "transpositionTable.h"
+
+// Move generation counter, in the spirit of 'perft' for chess engines. From an
+// empty Board and a sequence of Blocks, it counts the distinct Boards (after
+// clearing full rows) that can be reached by placing the next 'depth' Blocks,
+// summed over every line of play. The count is computed twice: once with the
+// Board's own Tile grid and its moving methods, which is the reference, and
+// once with the Reachability search on bitmasks, clearing full rows with a
+// BoardBatch. Both must always agree. Along the way, the features the
+// reference Boards keep up to date (and predict with 'evaluatePlacement') and
+// their hashes are checked against those computed from scratch, and every set of
+// BoardBatch kernels the CPU supports is checked on random Boards against the
+// scalar definitions and Board::clearFullRows.
+class Perft {
+    static constexpr int ROWS = MASK_ROWS, COLS = MASK_COLS;
+
+    // a Board of the fast counter, with the hash Board::getHash would give
+    // for it once its Block settled
+    struct Node {
+        RowMasks rows;
+        uint64_t hash;
+    };
+
+    // Level used for the Heavy property, and the Blocks to be placed in order
+    // (wrapping around like a sequence file)
+    int level;
+    std::vector<char> pieces;
+    // owner of the Blocks created while searching, whose score is meaningless,
+    // and what its random Levels would draw from
+    Random random;
+    std::unique_ptr<Player> player;
+    // where those Blocks are made
+    BlockPool blocks;
+    // coords of each kind of Block in the sequence when it is first placed,
+    // so the fast counter never has to create Blocks (and can run on many threads)
+    std::map<char, std::vector<std::pair<int, int>>> spawns;
+    // results of the fast counter by position, shared by all its threads, or
+    // nullptr if it is not used
+    std::unique_ptr<TranspositionTable> tt;
+    int threads;
+    // Boards whose features were checked by the reference counter, and how
+    // many of them did not match
+    uint64_t featureChecks = 0, featureMismatches = 0;
+    // same for their hashes
+    uint64_t hashChecks = 0, hashMismatches = 0;
+
+    BlockRef createBlock(char type);
+    char pieceAt(int ply) const;
+
+    // applies a moving command on a Board the same way Game::executeMove does,
+    // returns true if one of the Heavy 'down's could not be done, ending the turn
+    bool referenceMove(Board &board, int move, int mult) const;
+    // every distinct Board reachable by placing a Block of 'type' on 'board'
+    std::vector<Board> referenceChildren(const Board &board, char type);
+    uint64_t referenceCount(const Board &board, int ply, int depth);
+    // compares the features 'board' keeps, and those it predicted before its
+    // Block settled, with the ones computed from its Tiles
+    void checkFeatures(const Board &board, const BoardFeatures &predicted, int cleared);
+    // compares the hash 'board' keeps with the one of its settled Tiles, and
+    // the hash of its RowMasks with the one of all its Tiles
+    void checkHash(const Board &board);
+    // runs each set of BoardBatch kernels on the same random Boards, printing
+    // how many results were wrong, and returns false if any was
+    bool checkKernels(std::ostream &out);
+
+    std::vector<Node> fastChildren(const Node &node, char type);
+    uint64_t fastCount(const Node &node, int ply, int depth);
+    // same as 'fastCount', but looked up in the transposition table first, so
+    // a Board reached again by another order of moves is only counted once
+    uint64_t cachedCount(const Node &node, int ply, int depth);
+    // key of the subtree below a Board with 'boardHash' (Board::getHash), which
+    // depends on the Board and on every Block placed below it, not only the
+    // current and next ones
+    uint64_t subtreeKey(uint64_t boardHash, int ply, int depth) const;
+
+    public:
+        // 'hashMegabytes' is the size of the transposition table of the fast
+        // counter (0 for none), and 'threads' the number of threads it uses
+        Perft(std::vector<char> pieces, int level, size_t hashMegabytes = 0, int threads = 1);
+        // number of Boards reachable after placing 'depth' Blocks
+        uint64_t reference(int depth);
+        uint64_t fast(int depth);
+        // runs both counters for every depth up to 'depth', printing the counts,
+        // nodes/second and how well the transposition table did, and returns
+        // false if they ever disagree or a Board's features are ever wrong
+        bool run(int depth, std::ostream &out);
+};
+
+#endif
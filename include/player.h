@@ -5,6 +5,7 @@
 #include "probsOfLevels.h"
 #include <string>
 #include <memory>
+#include <vector>
 #include <cmath>
 
 class Player {
@@ -16,13 +17,21 @@ class Player {
     // the actual number of turns elapsed in the game, nor the number of turns
     // spent in Level 4 in total.
     int lvl4LastClearRow;
-    std::string seq;
-    std::unique_ptr<ProbsOfLevels> pol;
-    std::unique_ptr<Level> l;
+    // sequence file of Level 0, read once when the Player is created
+    std::shared_ptr<const BlockSequence> seq;
+    // every Level the Player can be on, created once with the Player, so that
+    // changing Levels only points 'l' to another one
+    std::unique_ptr<Level0> level0;
+    std::vector<std::unique_ptr<ProbsLevel>> probsLevels;
+    Level *l;
+    // last random Level the Player was on, whose 'norandom' settings are kept
+    // by the next random Level, or nullptr if there was none
+    ProbsLevel *lastProbs;
 
     public:
         // ctor
-        Player(std::string s, int startLevel);
+        // 'random' is shared with the Game's other Players, and must outlive them
+        Player(std::string s, int startLevel, Random &random);
         // setter, used by ctor and Game for 'levelup' and 'leveldown' commands
         void setLevel(int levelToSet);
         // getter methods
@@ -1,10 +1,12 @@
 #ifndef PROBS_LEVEL_H
 #define PROBS_LEVEL_H
 #include "level.h"
+#include "blockSequence.h"
+#include "random.h"
 #include <vector>
 #include <string>
-#include <fstream>
 #include <cstdlib>
+#include <memory>
 
 // for all classes that have to randomly generate blocks following certain
 // probabilities
@@ -17,15 +19,19 @@ class ProbsLevel: public Level {
         std::vector<float> probs;
         const float total = 1.0f;
         bool noRand;
-        std::string seq;
-        std::ifstream f;
+        // sequence followed when not random, read once by 'norandom', and the
+        // index of its next Block
+        std::shared_ptr<const BlockSequence> seq;
+        size_t next;
+        // numbers the random Blocks are picked with, shared by the Game's Players
+        Random *random;
 
         // private methods, depending on whether we want randomized blocks
         char produceRandBlock();
         char produceNoRandBlock();
 
     public:
-        ProbsLevel(const int l, const std::vector<float> p);
+        ProbsLevel(const int l, const std::vector<float> &p, Random &random);
         void setNoRand(std::string sequence = "") override;
         void setRand() override;
         char produceBlock() override;
@@ -33,6 +39,9 @@ class ProbsLevel: public Level {
         // randomizing settings
         bool isNoRand();
         std::string noRandSeq();
+        // takes over the randomizing settings of 'other', continuing its
+        // sequence where it left off
+        void followNoRand(const ProbsLevel &other);
         // dtor
         ~ProbsLevel();
 };
@@ -1,27 +1,27 @@
 #ifndef PROBSOFLEVELS_H
 #define PROBSOFLEVELS_H
 #include <vector>
-#include <unordered_map>
 
+// The probabilities are the same for every Player, so there is a single
+// immutable table shared by all of them
 class ProbsOfLevels {
-    std::vector<std::vector<float>> probabilities{
-        {1 / 6.0, 1 / 6.0, 1 / 6.0 , 1 / 6.0, 1 / 12.0, 1 / 12.0, 1 / 6.0},
-        {1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0},
-        {1 / 9.0, 1 / 9.0, 1 / 9.0, 1 / 9.0, 2 / 9.0, 2 / 9.0, 1 / 9.0, },
-    };
-    // hashmap that indicates which level corresponds to which probability index
-    // for 'probabilities'
-    std::unordered_map<int, int> lvlToProbIdx{
-        {1, 0},
-        {2, 1},
-        {3, 2},
-        {4, 2}
-    };
+    static const std::vector<std::vector<float>> &probabilities() {
+        static const std::vector<std::vector<float>> probs{
+            {1 / 6.0, 1 / 6.0, 1 / 6.0 , 1 / 6.0, 1 / 12.0, 1 / 12.0, 1 / 6.0},
+            {1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0, 1 / 7.0},
+            {1 / 9.0, 1 / 9.0, 1 / 9.0, 1 / 9.0, 2 / 9.0, 2 / 9.0, 1 / 9.0, },
+        };
+        return probs;
+    }
+
+    // indicates which level corresponds to which probability index for
+    // 'probabilities', starting from Level 1
+    static constexpr int lvlToProbIdx[] = {0, 1, 2, 2};
 
     public:
         // given a level number, returns the associated probability
-        std::vector<float> obtainLvlProb(int level) {
-            return probabilities[lvlToProbIdx[level]];
+        static const std::vector<float> &obtainLvlProb(int level) {
+            return probabilities()[lvlToProbIdx[level - 1]];
         }
 };
 
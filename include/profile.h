@@ -0,0 +1,67 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// Counters of the calls to the hot paths of the game, of the time spent in
+// them, and of the heap allocations (counted by the global operator new), all
+// off unless '-profile' turns them on. While off, each probe is a relaxed load
+// and a branch. The counters are shared by all threads.
+class Profile {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum Counter {
+            ParseCommand, TryMoveBlock, TryRotateBlock, DropBlock, ClearFullRows,
+            TextRender, GraphicRender,
+            // only counted, not timed
+            Turns,
+            NumCounters
+        };
+
+        // times one call to 'counter' for as long as it lives, including the
+        // calls it makes (so 'dropBlock' includes its 'tryMoveBlock's)
+        class Scope {
+            Counter counter;
+            bool on;
+            Clock::time_point start;
+
+            public:
+                explicit Scope(Counter counter): counter{counter}, on{isEnabled()} {
+                    if (on) start = Clock::now();
+                }
+                ~Scope() {
+                    if (on) record(counter, Clock::now() - start);
+                }
+                Scope(const Scope &) = delete;
+                Scope &operator=(const Scope &) = delete;
+        };
+
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        // turns the counters on, and prints them to std::cerr whenever the
+        // process gets SIGUSR1; to be called before any other thread starts,
+        // which then all leave SIGUSR1 to the thread waiting for it
+        static void enable();
+        // one call to 'counter', without timing it
+        static void count(Counter counter);
+        static void countAllocation(size_t bytes);
+        // calls, total and mean time of each counter, then the heap allocations
+        static void report(std::ostream &out);
+
+    private:
+        struct Stat {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> nanos{0};
+        };
+
+        static std::atomic<bool> enabled;
+        static Stat stats[NumCounters];
+        static std::atomic<uint64_t> allocations, allocatedBytes;
+
+        static void record(Counter counter, Clock::duration time);
+};
+
+#endif
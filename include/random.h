@@ -0,0 +1,27 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <array>
+#include <cstdint>
+
+// Pseudo-random numbers for one Game, so that Games running side by side (as
+// with '-serve') never draw from each other's sequence. It is the same
+// generator as glibc's rand(), which the Game used to share with the whole
+// process: seeded with 1, it gives the Blocks every Game gave before.
+class Random {
+    static constexpr int DEGREE = 31, SEPARATION = 3;
+
+    // the last DEGREE values of the sequence, value 'n' being at n % DEGREE
+    std::array<uint32_t, DEGREE> state;
+    int n;
+
+    uint32_t step();
+
+    public:
+        static constexpr int MAX = 2147483647;
+
+        explicit Random(unsigned seed = 1);
+        // next number, from 0 to MAX
+        int next();
+};
+
+#endif
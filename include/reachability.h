@@ -0,0 +1,109 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "rowMasks.h"
+
+template<int Rows, int Cols> class BasicBoard;
+using Board = BasicBoard<MASK_ROWS, MASK_COLS>;
+
+// A resting position of the current Block that can actually be reached from
+// its position on the Board using the moving commands and 'drop'
+struct Placement {
+    // bottom-left corner of the Block's bounding box, which is the point the
+    // Blocks rotate around, and the number of clockwise turns from the Block's
+    // orientation when the search started
+    int x, y, rotation;
+    // (col, row) coords of the Tiles of the Block once it has been placed
+    std::vector<std::pair<int, int>> coords;
+    // index of the search state, used to rebuild the commands that reach it
+    int state;
+};
+
+// Breadth-first search over every (x, y, rotation) position of a Block that
+// models the moves exactly as Game::executeMove performs them, including both
+// Heavy properties: at Level 'HEAVY_LVL' and above every moving command is
+// followed by 'HEAVY_LVL_DOWN' automatic 'down's, and the Heavy special action
+// adds 'HEAVY_SPEC_ACT_DOWN' more after 'left' and 'right'. A Block that cannot
+// move down during one of these ends the turn where it stands.
+class Reachability {
+    public:
+        static constexpr int ROWS = MASK_ROWS, COLS = MASK_COLS, ROTATIONS = 4;
+
+    private:
+        // mirrors the Heavy constants of Game
+        static constexpr int HEAVY_LVL = 3;
+        static constexpr int HEAVY_LVL_DOWN = 1;
+        static constexpr int HEAVY_SPEC_ACT_DOWN = 2;
+        static constexpr int NUM_STATES = ROWS * COLS * ROTATIONS;
+        static constexpr int MAX_CELLS = 4;
+
+        enum Move { LEFT = 0, RIGHT, DOWN, CW, CCW, DROP, NUM_MOVES };
+
+        // relative (dx, dy) of the Tiles for each orientation, with the
+        // bottom-left corner of the bounding box at (0, 0), so dx >= 0 and dy <= 0
+        struct Shape {
+            int numCells;
+            std::array<std::pair<int, int>, MAX_CELLS> cells;
+            int width, height;
+            // columns covered by the Shape in each of its rows, starting from
+            // the bottom one
+            std::array<uint16_t, MAX_CELLS> rowBits;
+        };
+
+        std::array<Shape, ROTATIONS> shapes;
+        // orientations that look identical (e.g. the OBlock) are folded onto
+        // the smallest equivalent rotation so they are only searched once
+        std::array<int, ROTATIONS> canonRot;
+        // settled Tiles, not including the Block being searched
+        RowMasks occupied;
+        int startX, startY;
+        int levelHeavy, specActHeavy;
+
+        // search bookkeeping, the parent of a state and the command (move and
+        // multiplier) that led to it. Resting positions keep their own parent,
+        // since the state a Block rests in may also be reached (and searched
+        // further) without the turn ending.
+        std::bitset<NUM_STATES> visited;
+        std::bitset<NUM_STATES> placed;
+        std::array<int, NUM_STATES> parent;
+        std::array<uint8_t, NUM_STATES> parentMove;
+        std::array<uint8_t, NUM_STATES> parentMult;
+        std::array<int, NUM_STATES> placeFrom;
+        std::array<uint8_t, NUM_STATES> placeMove;
+        std::array<uint8_t, NUM_STATES> placeMult;
+
+        static int encode(int x, int y, int rot);
+        static RowMasks settledRows(const Board &board);
+        static std::string commandName(int move, int mult);
+        void buildShapes(const std::vector<std::pair<int, int>> &coords);
+        // whether the Block in orientation 'rot' fits with its bottom-left corner at (x, y)
+        bool fits(int x, int y, int rot) const;
+        // applies a moving command 'mult' times followed by any Heavy 'down's,
+        // returns true if the Block could not move down during a Heavy 'down',
+        // which ends the turn
+        bool apply(int &x, int &y, int &rot, Move move, int mult) const;
+        int maxMultiplier(Move move) const;
+        void addPlacement(std::vector<Placement> &res, int x, int y, int rot, int from, Move move, int mult);
+
+    public:
+        // searches the current Block of 'board' from where it is, 'level' being
+        // the Level of the Board's Player and 'heavySpecAct' whether the Heavy
+        // special action is active on the Board
+        Reachability(const Board &board, int level, bool heavySpecAct);
+        // searches a Block with the given coords on top of the settled Tiles 'occupied'
+        Reachability(const std::vector<std::pair<int, int>> &blockCoords,
+                     const RowMasks &occupied, int level, bool heavySpecAct);
+
+        // every distinct reachable resting position, in the order they are found
+        std::vector<Placement> search();
+        // the commands leading to 'placement', meant to be fed to the Game
+        // exactly as a Player would type them (e.g. "3left", "clockwise", "drop")
+        std::vector<std::string> commandsFor(const Placement &placement) const;
+};
+
+#endif
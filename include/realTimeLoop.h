@@ -0,0 +1,72 @@
+#ifndef REAL_TIME_LOOP_H
+#define REAL_TIME_LOOP_H
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class Game;
+class KeyboardInput;
+
+// Plays a Game in real time: a timer on the monotonic clock ticks gravity (see
+// Game::tick) at an interval that depends on the Level of the Player on turn,
+// while the Players' commands are read as they come, from the input and from
+// the keys of the graphical window. A single event loop (epoll) waits on all of
+// them (the timer being a timerfd), and steps the Game after each, so there is
+// no thread between a tick or a key and the Board update (which the render
+// thread then draws).
+class RealTimeLoop {
+    using Clock = std::chrono::steady_clock;
+
+    // milliseconds between two ticks on each Level
+    static constexpr int TICK_MS[] = {1000, 800, 600, 400, 250};
+
+    Game &game;
+    int inFd, timerFd, epollFd;
+    bool gravity;
+    KeyboardInput *keys;
+    // input read after its last whole line, given to the Game once the line is
+    // whole, so the keys' commands never land in the middle of one
+    std::string partial;
+    // interval the timer is armed with, and the Player on turn when it was
+    int interval;
+    int turn;
+    // when the next tick is due
+    Clock::time_point deadline;
+
+    // how late each tick was woken up, and how long it then took to update
+    // the Board, in microseconds
+    std::vector<uint32_t> jitters, updates;
+    uint64_t missed;
+    // from reading each key press to the Frame showing it being published to
+    // the render thread, in microseconds
+    std::vector<uint32_t> keyLatencies;
+
+    static int tickInterval(int level);
+    // restarts the timer when the turn or the Level on turn changed, so a new
+    // Block always gets a whole interval
+    void rearm();
+    // each returns false once the Game is over
+    bool onTick();
+    bool onInput(char *buf, size_t size);
+    bool onKeys();
+
+    public:
+        // reads the commands from 'inFd', which is left open, and only makes
+        // the Blocks fall if 'gravity' is set
+        RealTimeLoop(Game &game, int inFd, bool gravity = true);
+        ~RealTimeLoop();
+        // whether the timer and event loop could be set up
+        bool isOpen() const;
+        // also reads the commands of the keys of the graphical window
+        void setKeyboard(KeyboardInput &keyboard);
+        // plays until the Game is over
+        void run();
+        // number of ticks, ticks missed because the loop was busy, and the
+        // mean, 99th percentile and worst jitter and tick to Board update times,
+        // then the same for the time from a key press to its pixels
+        void printStats(std::ostream &out) const;
+};
+
+#endif
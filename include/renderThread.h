@@ -0,0 +1,61 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "frame.h"
+#include "observer.h"
+#include "tripleBuffer.h"
+
+class Game;
+
+// Observer that draws the Game on a thread of its own, so a slow terminal or X
+// server never holds the Game up. Each notification copies the Game into a
+// Frame and publishes it through a triple buffer, without ever waiting; the
+// thread wakes up and draws the latest Frame with each FrameRenderer. Frames
+// published while it was still drawing are skipped (and counted), but a win is
+// always shown, and so is the last Frame once the thread is stopped.
+class RenderThread: public Observer {
+    Game *game;
+    std::vector<FrameRenderer *> renderers;
+    TripleBuffer<Frame> frames;
+    // changed with each Frame published and to stop, the thread waits on it
+    std::atomic<uint64_t> published{0};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    // the Game's side: wins so far and who won last, Frames published and lost
+    int wins = 0;
+    int winner = 0;
+    uint64_t frameCount = 0, dropped = 0;
+
+    // the thread's side: Frames drawn, the wins they showed, and the time from
+    // taking each Frame to having drawn it, in microseconds
+    uint64_t drawn = 0;
+    int drawnWins = 0;
+    uint64_t totalLatency = 0, maxLatency = 0;
+
+    void publish(bool won);
+    void draw(const Frame &frame);
+    void run();
+
+    public:
+        // 'renderers' are only ever used on the thread once it started
+        RenderThread(Game *game, std::vector<FrameRenderer *> renderers);
+        ~RenderThread();
+        RenderThread(const RenderThread &) = delete;
+        RenderThread &operator=(const RenderThread &) = delete;
+
+        void notify() override;
+        void notifyWin() override;
+        const char *name() const override { return "RenderThread"; }
+        // draws the last Frame published, then ends the thread
+        void stop();
+        // Frames published, drawn and dropped, and the mean and worst time
+        // from taking a Frame to having drawn it, once stopped
+        void printStats(std::ostream &out) const;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef ROW_MASKS_H
+#define ROW_MASKS_H
+#include <array>
+#include <cstdint>
+#include "boardDims.h"
+
+// The occupied Tiles of a Board as one bitmask per row, bit 'c' being set when
+// the Tile in column 'c' is occupied
+template<int Rows>
+using BasicRowMasks = std::array<uint16_t, Rows>;
+template<int Cols>
+constexpr uint16_t fullRowMask = (1 << Cols) - 1;
+
+constexpr int MASK_ROWS = StandardDims::ROWS, MASK_COLS = StandardDims::COLS;
+constexpr uint16_t FULL_ROW_MASK = fullRowMask<MASK_COLS>;
+using RowMasks = BasicRowMasks<MASK_ROWS>;
+
+// Clears full rows exactly like Board::clearFullRows (whose loop never checks
+// the top row itself) and returns the number of cleared rows
+template<int Rows, int Cols>
+int clearFullRows(BasicRowMasks<Rows> &rows) {
+    int clearedRows = 0;
+    int row = Rows - 1;
+
+    while (row > 0) {
+        // shift all rows above downwards, which removes the full row
+        if (rows[row] == fullRowMask<Cols>) {
+            for (int j = row; j > 0; --j) rows[j] = rows[j - 1];
+
+            rows[0] = 0;
+            ++clearedRows;
+        } else {
+            --row;
+        }
+    }
+
+    return clearedRows;
+}
+
+int clearFullRows(RowMasks &rows);
+
+#endif
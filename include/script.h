@@ -0,0 +1,66 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "command.h"
+
+class CommandInterpreter;
+
+// One line of a script file, resolved ahead of time
+struct ScriptOp {
+    // 'Resolved' ops already hold the commands CommandInterpreter::parseCommand
+    // gives for their line, 'Raw' ones (help, rename, macro, and every line
+    // after a rename or macro, as those change the commands) are parsed when
+    // they run
+    enum class Kind { Resolved, Raw };
+    Kind kind;
+    int line;
+    std::string text;
+    Commands commands;
+    // what CommandInterpreter::parseSpecAct gives for the line, whatever its
+    // kind, and the Player it targets (0 if none)
+    std::string specAct;
+    int target;
+    // whether the command takes a file name (sequence, norandom), and which
+    bool hasFilename;
+    std::string filename;
+    // what parsing the line tells the user, e.g. an unknown command
+    std::string message;
+    // a rename or macro, after which the commands may not be the same
+    bool changesCommands;
+};
+
+// A script file given with 'sequence', read in one go and turned into ops
+// before any of its commands run, so playing it needs no parsing per line.
+// The ops are also saved next to the file, as FILE.bqc, and reused by later
+// runs as long as neither the file's contents nor the commands have changed.
+class Script {
+    std::string file;
+    std::vector<ScriptOp> ops;
+    size_t next;
+    // lines that are neither commands nor special actions, with their numbers
+    std::vector<std::string> errors;
+    bool opened;
+
+    // 'lineErrors' are the errors without the file name
+    void compile(const std::string &text, const CommandInterpreter &ci, std::vector<std::string> &lineErrors);
+    // false if 'compiled' is missing, damaged or was made for another 'key'
+    bool loadCompiled(const std::string &compiled, uint64_t key, std::vector<std::string> &lineErrors);
+    void saveCompiled(const std::string &compiled, uint64_t key, const std::vector<std::string> &lineErrors) const;
+
+    public:
+        Script(const std::string &file, const CommandInterpreter &ci);
+
+        // false if the file could not be read
+        bool isOpen() const;
+        const std::string &getFile() const;
+        const std::vector<std::string> &getErrors() const;
+        // next op, or nullptr once every line was used
+        const ScriptOp *nextOp();
+        // no more ops are given, like a stream that failed
+        void abort();
+};
+
+#endif
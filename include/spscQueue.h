@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Fixed-size ring shared by exactly one producer thread and one consumer
+// thread, without any lock. Each side only ever writes its own index, and the
+// other side reads it with acquire ordering, so a slot is always completely
+// written before it can be read. A side that finds the ring full (or empty)
+// sleeps on the other side's index until it moves.
+template<typename T, size_t CAPACITY> class SpscQueue {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static constexpr int CACHE_LINE = 64;
+
+    std::array<T, CAPACITY> slots;
+    // the indices only ever grow, and are taken modulo CAPACITY to find the
+    // slot, so 'tail - head' is always the number of items in the ring. Each
+    // has its own cache line, so the two threads do not fight over one.
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+
+    public:
+        // producer only, returns false if the ring is full
+        bool tryPush(T &&item) {
+            size_t t = tail.load(std::memory_order_relaxed);
+
+            if (t - head.load(std::memory_order_acquire) == CAPACITY) return false;
+
+            slots[t % CAPACITY] = std::move(item);
+            tail.store(t + 1, std::memory_order_release);
+            tail.notify_one();
+
+            return true;
+        }
+
+        // producer only, waits for room if the ring is full
+        void push(T item) {
+            while (true) {
+                size_t h = head.load(std::memory_order_acquire);
+
+                if (tryPush(std::move(item))) return;
+
+                head.wait(h, std::memory_order_acquire);
+            }
+        }
+
+        // consumer only, returns false if the ring is empty
+        bool tryPop(T &item) {
+            size_t h = head.load(std::memory_order_relaxed);
+
+            if (tail.load(std::memory_order_acquire) == h) return false;
+
+            item = std::move(slots[h % CAPACITY]);
+            head.store(h + 1, std::memory_order_release);
+            head.notify_one();
+
+            return true;
+        }
+
+        // consumer only, waits for an item if the ring is empty
+        T pop() {
+            T item;
+
+            while (true) {
+                size_t t = tail.load(std::memory_order_acquire);
+
+                if (tryPop(item)) return item;
+
+                tail.wait(t, std::memory_order_acquire);
+            }
+        }
+};
+
+#endif
@@ -2,24 +2,34 @@
 #define TEXTOBSERVER_H
 #include <iostream>
 #include "observer.h"
+#include "frame.h"
 #include "game.h"
 #include "board.h"
 
-// Observer used for the text-based display
-class TextObserver: public Observer {
-    const int ROWS = 18, COLS = 11;
-    const int BLINDL = 2, BLINDR = 8, BLINDT = 2, BLINDB = 11;
-    const int P0_IDX = 0, P1_IDX = 1;
+// Observer used for the text-based display, showing the Boards of all the
+// Players side by side. Attached to the Game it draws as soon as notified;
+// otherwise it can be given Frames to draw (on another thread, see
+// RenderThread).
+class TextObserver: public Observer, public FrameRenderer {
+    static constexpr int ROWS = StandardDims::ROWS, COLS = StandardDims::COLS;
+    // space between the Boards of two Players
+    static constexpr const char *BOARD_GAP = "     ";
     // Output stream of the Observer
-    std::ostream &out = std::cout;
+    std::ostream &out;
     // Pointer to the Game subject
     Game *game;
-    void print();
+    // the Game as last notified, kept to reuse its storage
+    Frame frame;
+    void printBorder(const Frame &frame);
+    void print(const Frame &frame);
 
     public:
-        TextObserver(Game *game);
+        TextObserver(Game *game, std::ostream &out = std::cout);
         void notify() override;
         void notifyWin() override;
+        const char *name() const override { return "TextObserver"; }
+        void render(const Frame &frame) override;
+        void renderWin(const Frame &frame) override;
         ~TextObserver() = default;
 };
 #endif
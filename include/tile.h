@@ -1,19 +1,17 @@
 #ifndef TILE_H
 #define TILE_H
 
-#include <memory>
-
-class Block; // Forward declaration
+#include "blockPool.h"
 
 // Tile class that represents 1 tile on the board
 class Tile {
         char symbol;
         bool isOccupied;
-        std::shared_ptr<Block> parent = nullptr; // pointer to the parent
+        BlockRef parent; // reference to the parent, which lives as long as one of its Tiles
     public:
         char getSymbol() const;
         bool getIsOccupied() const;
-        Tile(char symbol = ' ', bool isOccupied = false, std::shared_ptr<Block> parent = nullptr);
+        Tile(char symbol = ' ', bool isOccupied = false, BlockRef parent = nullptr);
 };
 
 #endif
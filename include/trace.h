@@ -0,0 +1,52 @@
+#ifndef TRACE_H
+#define TRACE_H
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Timeline of what each thread of the game did, written with '-trace' as
+// Chrome trace-event JSON (one track per thread, loaded as is by Perfetto or
+// chrome://tracing). Each thread records its spans into a buffer of its own,
+// without any lock or allocation but once per few thousand spans, and the
+// buffers are only read when the trace is written. While off, each span is a
+// relaxed load and a branch.
+class Trace {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // one span of the calling thread's track, for as long as it lives;
+        // 'category' and 'name' must be string literals (they are kept as is)
+        class Span {
+            const char *category;
+            const char *name;
+            bool on;
+            Clock::time_point start;
+
+            public:
+                Span(const char *category, const char *name):
+                    category{category}, name{name}, on{isEnabled()} {
+                    if (on) start = Clock::now();
+                }
+                ~Span() {
+                    if (on) record(category, name, start, Clock::now());
+                }
+                Span(const Span &) = delete;
+                Span &operator=(const Span &) = delete;
+        };
+
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        // starts the trace, naming the calling thread's track 'game'
+        static void enable();
+        // names the calling thread's track (a string literal), if tracing
+        static void nameThread(const char *name);
+        // writes every span recorded so far, false if 'path' cannot be written;
+        // spans still being recorded by other threads may or may not be in it
+        static bool write(const std::string &path);
+
+    private:
+        static std::atomic<bool> enabled;
+
+        static void record(const char *category, const char *name, Clock::time_point start, Clock::time_point end);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size hash table caching search results by position, so positions that
+// are reached again through a different order of moves are only searched once.
+// Entries are grouped in buckets the size of a cache line, so a probe touches a
+// single line. Probes and stores never lock: each entry stores its data along
+// with the key XORed with that data, so an entry torn by two threads writing at
+// once no longer matches its key and simply reads as a miss.
+class TranspositionTable {
+    public:
+        // how a store picks the entry to overwrite when its bucket is full
+        enum class Replace {
+            // the newest result always goes in, overwriting the entries of a
+            // bucket in turn (round-robin), so the oldest store goes first
+            Newest,
+            // the entry searched to the shallowest depth goes first, as deeper
+            // results are the most expensive to redo
+            DepthPreferred
+        };
+
+        struct Stats {
+            uint64_t probes, hits, stores, overwrites;
+            double hitRate() const;
+        };
+
+    private:
+        static constexpr int CACHE_LINE = 64;
+        static constexpr int ENTRIES_PER_BUCKET = 4;
+        static constexpr int VALUE_BITS = 56;
+        static constexpr uint64_t VALUE_MASK = (uint64_t{1} << VALUE_BITS) - 1;
+
+        // 'data' holds the value in its low bits and 1 + depth in its top 8
+        // bits, so a used entry is never 0
+        struct Entry {
+            std::atomic<uint64_t> check;
+            std::atomic<uint64_t> data;
+        };
+
+        struct alignas(CACHE_LINE) Bucket {
+            Entry entries[ENTRIES_PER_BUCKET];
+        };
+
+        std::unique_ptr<Bucket[]> buckets;
+        // with Replace::Newest, the entry of each bucket to overwrite next;
+        // kept apart from the buckets so they still fit a cache line, and only
+        // touched by stores into a full bucket
+        std::unique_ptr<std::atomic<uint8_t>[]> cursors;
+        size_t mask;
+        Replace policy;
+
+        std::atomic<uint64_t> probes, hits, stores, overwrites;
+
+        Bucket &bucketFor(uint64_t key) const;
+        static int depthOf(uint64_t data);
+
+    public:
+        // uses at most 'megabytes' of memory, rounded down to a power of two of
+        // buckets (plus one byte per bucket with Replace::Newest)
+        TranspositionTable(size_t megabytes, Replace policy = Replace::DepthPreferred);
+
+        // key of a position from the hash of its Board and the current and next Blocks
+        static uint64_t positionKey(uint64_t boardHash, char current, char next);
+
+        // returns true and sets 'value' and 'depth' if 'key' is in the table
+        bool probe(uint64_t key, uint64_t &value, int &depth);
+        // 'value' must fit in 56 bits and 'depth' be between 0 and 254
+        void store(uint64_t key, uint64_t value, int depth);
+        void clear();
+        Stats stats() const;
+        // number of entries the table can hold
+        size_t capacity() const;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+#include <atomic>
+
+// Three slots shared by exactly one writer thread and one reader thread,
+// without any lock and without either ever waiting on the other. The writer
+// fills its own slot and publishes it by swapping it with the middle one; the
+// reader takes the middle slot by swapping it with its own. The reader so
+// always gets the latest slot published, and a slot published twice before
+// the reader took it is simply written over.
+template<typename T> class TripleBuffer {
+    static constexpr int CACHE_LINE = 64;
+    // set in 'middle' while the middle slot holds a slot the reader has not taken
+    static constexpr unsigned FRESH = 4;
+
+    T slots[3];
+    // index of the middle slot, and FRESH
+    alignas(CACHE_LINE) std::atomic<unsigned> middle{1};
+    // each only used by its own side
+    alignas(CACHE_LINE) unsigned back = 0;
+    alignas(CACHE_LINE) unsigned front = 2;
+
+    public:
+        // writer only, the slot to fill before 'publish'
+        T &writeSlot() { return slots[back]; }
+
+        // writer only, returns true if the slot published before was never
+        // taken by the reader (and is now lost)
+        bool publish() {
+            unsigned old = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+            back = old & ~FRESH;
+
+            return old & FRESH;
+        }
+
+        // reader only, takes the latest slot published, returns false if there
+        // was none since the last time
+        bool take() {
+            if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+            front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+
+            return true;
+        }
+
+        // reader only, the slot last taken
+        const T &readSlot() const { return slots[front]; }
+};
+
+#endif
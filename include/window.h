@@ -19,6 +19,8 @@ class Xwindow {
 
   int getWidth() const;
   int getHeight() const;
+  // id of the window on the X server, for other connections to it
+  unsigned long getWindow() const;
 
   // Draws a rectangle
   void fillRectangle(int x, int y, int width, int height, int colour=Black);
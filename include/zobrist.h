@@ -0,0 +1,30 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+#include <array>
+#include <cstdint>
+#include "boardDims.h"
+#include "rowMasks.h"
+
+// Random 64-bit keys for every (row, col) of a Board. The hash of a Board is
+// the XOR of the keys of its occupied Tiles, so changing a Tile only takes
+// XORing its key. Which Block a Tile came from does not change how the Board
+// plays, so it is left out, and the hash of a Board is also that of its
+// RowMasks. The keys are always generated from the same seed, so hashes can
+// be compared across runs.
+template<int Rows, int Cols>
+class BasicZobrist {
+    static constexpr int ROWS = Rows, COLS = Cols;
+    using Table = std::array<std::array<uint64_t, COLS>, ROWS>;
+
+    static const Table &table();
+
+    public:
+        // key of an occupied Tile at (row, col)
+        static uint64_t key(int row, int col);
+        // hash of the Board whose occupied Tiles are 'rows'
+        static uint64_t hash(const BasicRowMasks<Rows> &rows);
+};
+
+using Zobrist = BasicZobrist<StandardDims::ROWS, StandardDims::COLS>;
+
+#endif
@@ -1,15 +1,48 @@
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "block.h"
+#include "blockSequence.h"
+#include "eventStream.h"
 #include "board.h"
 #include "game.h"
+#include "gameServer.h"
 #include "observer.h"
 #include "textObserver.h"
 #include "graphicObserver.h"
+#include "inputReader.h"
+#include "keyboardInput.h"
+#include "perft.h"
+#include "profile.h"
+#include "trace.h"
+#include "realTimeLoop.h"
+#include "renderThread.h"
 #include "tile.h"
 
+// range of the number of Players a Game can have
+const int MIN_PLAYERS = 2, MAX_PLAYERS = 8;
+
+// Player (from 1) named at the end of an option such as '-scriptfile3', or 0 if
+// 'arg' is not 'prefix' followed by a Player's number
+int playerOption(const std::string& arg, const std::string& prefix) {
+    if (arg.size() <= prefix.size() || arg.size() > prefix.size() + 2 ||
+        arg.compare(0, prefix.size(), prefix) != 0) return 0;
+
+    std::string num = arg.substr(prefix.size());
+
+    if (!std::all_of(num.begin(), num.end(), [](unsigned char c) { return std::isdigit(c); })) return 0;
+
+    int player = std::stoi(num);
+
+    return player <= MAX_PLAYERS ? player : 0;
+}
+
 int main(int argc, char* argv[]) {
   
     // constants indicating the number/range of available levels
@@ -17,13 +50,60 @@ int main(int argc, char* argv[]) {
     // setting up the default options, if none are supplied
     bool textOnly = false;
     int seed = 1;
-    std::string seq1 = "sequence1.txt", seq2 = "sequence2.txt";
+    int numPlayers = MIN_PLAYERS;
+    // sequence file of each Player, the odd Players using sequence1.txt and the
+    // even ones sequence2.txt unless told otherwise
+    std::vector<std::string> seqs(MAX_PLAYERS);
+
+    for (int p = 0; p < MAX_PLAYERS; ++p) seqs[p] = p % 2 == 0 ? "sequence1.txt" : "sequence2.txt";
+
     int startLevel = 0;
     bool bonus = false;
+    // depth of the move generation counter, 0 meaning we play the game instead
+    int perftDepth = 0;
+    // size in MB of the transposition table the counter uses, and its threads
+    int perftHash = 16, perftThreads = 1;
+    // files each Player reads their commands from, std::cin if empty
+    std::vector<std::string> inputs(MAX_PLAYERS);
+    // highest Player named by an option, who must be part of the Game
+    int highestPlayer = 0;
+    // socket the server listens on (and its number of workers), or that the
+    // test client connects to
+    std::string serveSocket, connectSocket;
+    int serveWorkers = 4;
+    // whether Blocks fall on their own as time passes
+    bool realTime = false;
+    // whether the text display is drawn on the render thread too
+    bool asyncText = false;
+    // Boards shown per second while replaying a file, every one if negative
+    int replayFps = -1;
+    // files and FIFOs the Game is broadcast to
+    std::vector<std::string> broadcasts;
+    // whether to count the calls to the hot paths and the heap allocations
+    bool profile = false;
+    // file the timeline of the Game's threads is written to, if any
+    std::string tracePath;
 
     // iterating through the command line arguments, if any
     int i = 1;
 
+    // moves to the value of the option at 'i', false if it was the last argument
+    auto nextValue = [&](const std::string& option) {
+        if (++i < argc) return true;
+
+        std::cerr << "Missing value after " << option << "." << std::endl;
+
+        return false;
+    };
+    // whether the value given to 'option' is at least 'min'
+    auto atLeast = [](const std::string& option, int value, int min) {
+        if (value >= min) return true;
+
+        std::cerr << "Invalid value for " << option << ", it must be at least " << min << "." << std::endl;
+
+        return false;
+    };
+
     // very basic command checking, assuming that any command that comes in pairs
     // have their appropriate command name + argument
     while (i < argc) {
@@ -31,16 +111,25 @@ int main(int argc, char* argv[]) {
 
         if (s == "-text") textOnly = true;
         else if (s == "-seed") {
-            ++i;
+            if (!nextValue(s)) return 1;
             seed = std::stoi(argv[i]);
-        } else if (s == "-scriptfile1") {
-            ++i;
-            seq1 = argv[i];
-        } else if (s == "-scriptfile2") {
-            ++i;
-            seq2 = argv[i];
+        } else if (int p = playerOption(s, "-scriptfile")) {
+            if (!nextValue(s)) return 1;
+            seqs[p - 1] = argv[i];
+            highestPlayer = std::max(highestPlayer, p);
+        } else if (s == "-players") {
+            if (!nextValue(s)) return 1;
+            numPlayers = std::stoi(argv[i]);
+
+            if (numPlayers < MIN_PLAYERS || numPlayers > MAX_PLAYERS) {
+                std::cerr << "Invalid number of players. A game has from "
+                          << MIN_PLAYERS << " to " << MAX_PLAYERS << " players, inclusive."
+                          << std::endl;
+
+                return 1;
+            }
         } else if (s == "-startlevel") {
-            ++i;
+            if (!nextValue(s)) return 1;
             startLevel = std::stoi(argv[i]);
 
             if (startLevel < LOWEST_LEVEL || startLevel > HIGHEST_LEVEL) {
@@ -51,14 +140,74 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         } else if (s == "-bonus") bonus = true;
-        else {
+        else if (s == "-perft") {
+            if (!nextValue(s)) return 1;
+            perftDepth = std::stoi(argv[i]);
+
+            if (!atLeast(s, perftDepth, 1)) return 1;
+        } else if (s == "-hash") {
+            if (!nextValue(s)) return 1;
+            perftHash = std::stoi(argv[i]);
+
+            // 0 turns the table off
+            if (!atLeast(s, perftHash, 0)) return 1;
+        } else if (s == "-threads") {
+            if (!nextValue(s)) return 1;
+            perftThreads = std::stoi(argv[i]);
+
+            if (!atLeast(s, perftThreads, 1)) return 1;
+        } else if (int p = playerOption(s, "-input")) {
+            if (!nextValue(s)) return 1;
+            inputs[p - 1] = argv[i];
+            highestPlayer = std::max(highestPlayer, p);
+        } else if (s == "-serve") {
+            if (!nextValue(s)) return 1;
+            serveSocket = argv[i];
+        } else if (s == "-workers") {
+            if (!nextValue(s)) return 1;
+            serveWorkers = std::stoi(argv[i]);
+
+            if (!atLeast(s, serveWorkers, 1)) return 1;
+        } else if (s == "-realtime") realTime = true;
+        else if (s == "-asynctext") asyncText = true;
+        else if (s == "-profile") profile = true;
+        else if (s == "-trace") {
+            if (!nextValue(s)) return 1;
+            tracePath = argv[i];
+        } else if (s == "-broadcast") {
+            if (!nextValue(s)) return 1;
+            broadcasts.push_back(argv[i]);
+        } else if (s == "-replayfps") {
+            if (!nextValue(s)) return 1;
+            replayFps = std::stoi(argv[i]);
+        } else if (s == "-connect") {
+            if (!nextValue(s)) return 1;
+            connectSocket = argv[i];
+        } else {
             std::cerr << "Invalid command. Valid commands are:\n"
                       << "\t'-bonus'\n"
                       << "\t'-text'\n"
                       << "\t'-seed SEEDVAL', replace SEEDVAL with a seed value\n"
                       << "\t'-scriptfile1 FILENAME', replace FILENAME with an existing file name\n"
                       << "\t'-scriptfile2 FILENAME', replace FILENAME with an existing file name\n"
-                      << "\t'-startlevel LEVEL', replace LEVEL with an appropriate level\n";
+                      << "\t'-scriptfileN FILENAME', sequence file of Player N when there are more than two\n"
+                      << "\t'-players N', number of players, from " << MIN_PLAYERS << " to " << MAX_PLAYERS << "\n"
+                      << "\t'-startlevel LEVEL', replace LEVEL with an appropriate level\n"
+                      << "\t'-perft DEPTH', count the Boards reachable by placing DEPTH Blocks from '-scriptfile1'\n"
+                      << "\t'-hash MB', size of the transposition table used by '-perft' (0 for none)\n"
+                      << "\t'-threads N', number of threads used by '-perft'\n"
+                      << "\t'-input1 FILENAME', read Player 1's commands from a file or FIFO (e.g. /dev/fd/3)\n"
+                      << "\t'-input2 FILENAME', read Player 2's commands from a file or FIFO\n"
+                      << "\t'-inputN FILENAME', read Player N's commands from a file or FIFO\n"
+                      << "\t'-serve SOCKET', host a text-only Game for every client of a Unix domain socket\n"
+                      << "\t'-workers N', number of threads running the Games of '-serve'\n"
+                      << "\t'-connect SOCKET', play on a '-serve' server from this terminal\n"
+                      << "\t'-realtime', Blocks fall on their own, faster on higher levels\n"
+                      << "\t'-asynctext', draw the text display on its own thread, skipping Boards it cannot keep up with\n"
+                      << "\t'-replayfps F', show the Boards at most F times a second while replaying a file (0: once a turn)\n"
+                      << "\t'-broadcast PATH', write the Game's events to a file or FIFO, may be given more than once\n"
+                      << "\t'-profile', count the calls to the hot paths and the heap allocations, printed at exit or on SIGUSR1\n"
+                      << "\t'-trace FILE', write a timeline of each thread of the Game to FILE, as Chrome trace-event JSON\n";
             
             return 1;
         }
@@ -66,17 +215,197 @@ int main(int argc, char* argv[]) {
         ++i;
     }
 
-    std::unique_ptr<Game> game(new Game{bonus, seed, seq1, seq2, startLevel});
-    std::unique_ptr<Observer> textObs(new TextObserver{game.get()});
-    game->attach(textObs.get());
-
-    // playing with graphical observer as well
-    if (!textOnly) {
-        std::unique_ptr<Observer> graphObs(new GraphicObserver{game.get()});
-        game->attach(graphObs.get());
-        game->play();
-    // not creating the graphical observer at all in the case where the Player(s)
-    // only want a text display
+    if (highestPlayer > numPlayers) {
+        std::cerr << "There is no player " << highestPlayer << " in a game of "
+                  << numPlayers << " players." << std::endl;
+
+        return 1;
+    }
+
+    seqs.resize(numPlayers);
+    inputs.resize(numPlayers);
+
+    bool ownInputs = std::any_of(inputs.begin(), inputs.end(), [](const std::string& in) { return !in.empty(); });
+
+    if (realTime && ownInputs) {
+        std::cerr << "All players read standard input in real time." << std::endl;
+
+        return 1;
+    }
+
+    // before any thread is started, so SIGUSR1 only goes to the one printing
+    if (profile) Profile::enable();
+
+    // the same files are loaded again by the Players, from the cache
+    for (const std::string &seq : seqs) {
+        std::shared_ptr<const BlockSequence> blocks = BlockSequence::load(seq);
+
+        if (!blocks->isValid()) {
+            std::cerr << blocks->getError() << std::endl;
+            return 1;
+        }
+    }
+
+    if (perftDepth > 0) {
+        // the Blocks are placed in the order of the first sequence file
+        std::shared_ptr<const BlockSequence> pieces = BlockSequence::load(seqs[0]);
+
+        if (pieces->empty()) {
+            std::cerr << "Cannot read any Blocks from " << seqs[0] << std::endl;
+            return 1;
+        }
+
+        Perft perft{pieces->getBlocks(), startLevel, static_cast<size_t>(perftHash), perftThreads};
+
+        bool match = perft.run(perftDepth, std::cout);
+
+        if (profile) Profile::report(std::cerr);
+
+        return match ? 0 : 1;
+    }
+
+    if (!serveSocket.empty()) {
+        GameServer server{serveSocket, serveWorkers, bonus, seed, seqs, startLevel};
+
+        if (!server.run()) {
+            std::cerr << "Cannot serve on " << serveSocket << std::endl;
+            return 1;
+        }
+
+        return 0;
+    } else if (!connectSocket.empty()) {
+        if (!GameServer::client(connectSocket)) {
+            std::cerr << "Cannot connect to " << connectSocket << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    // before the Game's threads start, so they all have a track
+    if (!tracePath.empty()) Trace::enable();
+
+    // the keys of the window are read as soon as they are pressed, along with
+    // standard input, unless some Player reads their own input
+    bool keys = !textOnly && !ownInputs;
+
+    // std::cin is read on its own thread while the game runs, and so is each
+    // Player's own input if they have one, except in real time or with the keys
+    // where standard input is waited on along with the timer and keys instead
+    std::unique_ptr<InputReader> input;
+
+    if (!realTime && !keys) {
+        input = std::make_unique<InputReader>(STDIN_FILENO);
+        input->replace(std::cin);
+    }
+
+    std::vector<std::unique_ptr<InputReader>> playerInputs(numPlayers);
+
+    for (int p = 0; p < numPlayers; ++p) {
+        if (inputs[p].empty()) continue;
+
+        playerInputs[p] = std::make_unique<InputReader>(inputs[p]);
+
+        if (!playerInputs[p]->isOpen()) {
+            std::cerr << "Cannot open " << inputs[p] << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Game> game(new Game{bonus, seed, seqs, startLevel});
+
+    for (int p = 0; p < numPlayers; ++p) {
+        if (playerInputs[p]) game->setInput(p, playerInputs[p]->stream());
+    }
+
+    if (replayFps >= 0) {
+        game->setReplayRendering(replayFps);
+
+        // commands redirected from a file are replayed as sequence files are
+        for (int p = 0; p < numPlayers; ++p) {
+            struct stat st;
+            bool isFile = inputs[p].empty() ? fstat(STDIN_FILENO, &st) == 0 : stat(inputs[p].c_str(), &st) == 0;
+
+            if (isFile && S_ISREG(st.st_mode)) game->setFileInput(p);
+        }
+    }
+
+    std::unique_ptr<TextObserver> textObs(new TextObserver{game.get()});
+
+    // playing with graphical observer as well, not creating it at all in the
+    // case where the Player(s) only want a text display
+    std::unique_ptr<GraphicObserver> graphObs;
+
+    if (!textOnly) graphObs.reset(new GraphicObserver{game.get()});
+
+    // the window is always drawn on the render thread, the text only if asked
+    // since it is otherwise printed in order with the Game's own messages
+    std::vector<FrameRenderer *> rendered;
+
+    if (asyncText) rendered.push_back(textObs.get());
+    else game->attach(textObs.get());
+
+    if (graphObs) rendered.push_back(graphObs.get());
+
+    std::unique_ptr<EventStream> events;
+
+    if (!broadcasts.empty()) {
+        events = std::make_unique<EventStream>(game.get());
+
+        if (!events->isOpen()) {
+            std::cerr << "Cannot set up the event stream" << std::endl;
+            return 1;
+        }
+
+        for (auto &path : broadcasts) events->addSink(path);
+
+        game->attach(events.get());
+    }
+
+    std::unique_ptr<RenderThread> render;
+
+    if (!rendered.empty()) {
+        render = std::make_unique<RenderThread>(game.get(), rendered);
+        game->attach(render.get());
+    }
+
+    if (realTime || keys) {
+        RealTimeLoop loop{*game, STDIN_FILENO, realTime};
+
+        if (!loop.isOpen()) {
+            std::cerr << "Cannot set up the event loop" << std::endl;
+            return 1;
+        }
+
+        std::unique_ptr<KeyboardInput> keyboard;
+
+        if (keys) {
+            keyboard = std::make_unique<KeyboardInput>(graphObs->getWindow());
+
+            // playing on with standard input alone
+            if (keyboard->isOpen()) loop.setKeyboard(*keyboard);
+            else std::cerr << "Cannot read the keys of the window" << std::endl;
+        }
+
+        loop.run();
+        loop.printStats(std::cerr);
     } else game->play();
 
+    if (render) {
+        render->stop();
+        render->printStats(std::cerr);
+    }
+
+    if (profile) {
+        const BlockPool &blocks = game->getBlockPool();
+
+        Profile::report(std::cerr);
+        std::cerr << "  " << blocks.blocksCreated() << " Blocks made in " << blocks.capacity() << " slots ("
+                  << blocks.chunkAllocations() << " allocations)" << std::endl;
+    }
+
+    if (!tracePath.empty() && !Trace::write(tracePath)) {
+        std::cerr << "Cannot write the trace to " << tracePath << std::endl;
+    }
+
 }
@@ -4,13 +4,17 @@
 
 // Abstract Block class
 Block::~Block(){} // Destructor implemented in derived classes
-std::vector<std::pair<int, int>> Block::getCoords() const { return coords; }
+BlockCoords::BlockCoords(std::initializer_list<std::pair<int, int>> coords) {
+    for (const auto &coord : coords) items[count++] = coord;
+}
+
+const BlockCoords &Block::getCoords() const { return coords; }
 char Block::getBlockSymbol() { return tileSymbol; }
 
 // New coords for rotation
 // Get rotated coords
-std::vector<std::pair<int, int>> Block::computeRotatedCoords(string dir) const {
-    std::vector<std::pair<int, int>> res;
+BlockCoords Block::computeRotatedCoords(string dir) const {
+    BlockCoords res;
     std::pair<int, int> prevBottomLeft = bottomLeft;
     int adjustX;
     int adjustY;
@@ -70,8 +74,8 @@ void Block::rotate(string dir) {
 }
 
 // New coords for movement
-std::vector<std::pair<int, int>> Block::computeMovedCoords(string dir) const {
-    std::vector<std::pair<int, int>> res;
+BlockCoords Block::computeMovedCoords(string dir) const {
+    BlockCoords res;
     // Move left
     if (dir == "l") {
         for (auto it : coords) {
@@ -139,12 +143,15 @@ OBlock::OBlock(int lvl, Player *player) {
     topRight = {1,2};
 }
 // New coords for a OBlock rotation
-std::vector<std::pair<int, int>> OBlock::computeRotatedCoords(string dir) const {
+BlockCoords OBlock::computeRotatedCoords(string dir) const {
     return coords;
 }
 // Construct and return the tile by value
 Tile OBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef OBlock::clone(BlockPool &pool) const {
+    return pool.make<OBlock>(*this);
 }
 OBlock::~OBlock() {
     player->scoreBlock(origLvl);
@@ -164,7 +171,10 @@ IBlock::IBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile IBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef IBlock::clone(BlockPool &pool) const {
+    return pool.make<IBlock>(*this);
 }
 IBlock::~IBlock() {
     player->scoreBlock(origLvl);
@@ -186,7 +196,10 @@ SBlock::SBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile SBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef SBlock::clone(BlockPool &pool) const {
+    return pool.make<SBlock>(*this);
 }
 SBlock::~SBlock() {
     player->scoreBlock(origLvl);
@@ -207,7 +220,10 @@ ZBlock::ZBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile ZBlock::getBlockTile() {
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef ZBlock::clone(BlockPool &pool) const {
+    return pool.make<ZBlock>(*this);
 }
 ZBlock::~ZBlock() {
     player->scoreBlock(origLvl);
@@ -228,7 +244,10 @@ JBlock::JBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile JBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef JBlock::clone(BlockPool &pool) const {
+    return pool.make<JBlock>(*this);
 }
 JBlock::~JBlock() {
     player->scoreBlock(origLvl);
@@ -249,7 +268,10 @@ LBlock::LBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile LBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef LBlock::clone(BlockPool &pool) const {
+    return pool.make<LBlock>(*this);
 }
 LBlock::~LBlock() {
     player->scoreBlock(origLvl);
@@ -270,7 +292,10 @@ TBlock::TBlock(int lvl, Player *player) {
 }
 // Construct and return the tile by value
 Tile TBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef TBlock::clone(BlockPool &pool) const {
+    return pool.make<TBlock>(*this);
 }
 TBlock::~TBlock() {
     player->scoreBlock(origLvl);
@@ -289,7 +314,10 @@ StarBlock::StarBlock(Player *player) {
 }
 // Construct and return the tile by value
 Tile StarBlock::getBlockTile() { 
-    return Tile(tileSymbol, true, shared_from_this());
+    return Tile(tileSymbol, true, BlockRef{pool, handle});
+}
+BlockRef StarBlock::clone(BlockPool &pool) const {
+    return pool.make<StarBlock>(*this);
 }
 StarBlock::~StarBlock() {
     player->scoreBlock(origLvl);
@@ -0,0 +1,31 @@
+#include "blockPool.h"
+#include "block.h"
+
+uint32_t BlockPool::acquire() {
+    if (!freeList) {
+        uint32_t first = chunks.size() * CHUNK_SLOTS + 1;
+
+        chunks.push_back(std::make_unique<Slot[]>(CHUNK_SLOTS));
+
+        // the new slots are taken in order, first to last
+        for (uint32_t handle = first + CHUNK_SLOTS - 1; handle >= first; --handle) {
+            slot(handle).nextFree = freeList;
+            freeList = handle;
+        }
+    }
+
+    uint32_t handle = freeList;
+    freeList = slot(handle).nextFree;
+
+    return handle;
+}
+
+void BlockPool::destroy(uint32_t handle) {
+    Slot &s = slot(handle);
+
+    // the Block's dtor scores it for its Player
+    s.block->~Block();
+    s.block = nullptr;
+    s.nextFree = freeList;
+    freeList = handle;
+}
@@ -0,0 +1,65 @@
+#include "blockSequence.h"
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+
+BlockSequence::BlockSequence(const std::string &file): file{file} {
+    const std::string valid = "IJLOSZT";
+    std::ifstream f{file};
+    char c;
+    int line = 1;
+
+    while (f.get(c)) {
+        if (c == '\n') ++line;
+
+        if (std::isspace(static_cast<unsigned char>(c))) continue;
+        else if (valid.find(c) != std::string::npos) blocks.push_back(c);
+        else if (error.empty()) {
+            error = file + ":" + std::to_string(line) + ": '" + c + "' is not a Block";
+        }
+    }
+}
+
+std::shared_ptr<const BlockSequence> BlockSequence::load(const std::string &file) {
+    struct Cached {
+        struct timespec mtime;
+        std::shared_ptr<const BlockSequence> seq;
+    };
+
+    static std::mutex m;
+    static std::map<std::string, Cached> cache;
+    struct stat st;
+
+    // a file that cannot be found is not cached, as it may be created later
+    if (stat(file.c_str(), &st) != 0) return std::make_shared<BlockSequence>(file);
+
+    std::lock_guard<std::mutex> lock{m};
+    auto it = cache.find(file);
+
+    if (it != cache.end() && it->second.mtime.tv_sec == st.st_mtim.tv_sec &&
+        it->second.mtime.tv_nsec == st.st_mtim.tv_nsec) {
+        return it->second.seq;
+    }
+
+    // read while holding the lock, so a file is never read twice at once
+    auto seq = std::make_shared<const BlockSequence>(file);
+    cache[file] = {st.st_mtim, seq};
+
+    return seq;
+}
+
+const std::string &BlockSequence::getFile() const { return file; }
+
+const std::vector<char> &BlockSequence::getBlocks() const { return blocks; }
+
+size_t BlockSequence::size() const { return blocks.size(); }
+
+bool BlockSequence::empty() const { return blocks.empty(); }
+
+char BlockSequence::at(size_t i) const { return blocks.empty() ? 0 : blocks[i % blocks.size()]; }
+
+bool BlockSequence::isValid() const { return error.empty(); }
+
+const std::string &BlockSequence::getError() const { return error; }
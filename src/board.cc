@@ -1,11 +1,16 @@
 #include "board.h"
 #include "tile.h"
 #include "block.h"
+#include "profile.h"
+#include "trace.h"
+#include "zobrist.h"
 #include <memory>
+#include <utility>
 
 // Constructor
-Board::Board(): isBlindBoard{false} {
-    grid.resize(ROWS, std::vector<Tile>(COLS));
+template<int Rows, int Cols>
+BasicBoard<Rows, Cols>::BasicBoard(): isBlindBoard{false}, hash{0}, blockPlaced{false}, rowMasks{},
+    dirtyCols{fullRowMask<Cols>}, dirtyRows{(1u << ROWS) - 1} {
     // Set all to blank initially
     for (int i = 0; i < ROWS; ++i) {
         for (int j = 0; j < COLS; ++j) {
@@ -15,29 +20,37 @@ Board::Board(): isBlindBoard{false} {
     }
 }
 
-char Board::charAt(int row, int col) const {
-    if (row >= BLINDL && row <= BLINDR && col >= BLINDT && col <= BLINDB && isBlindBoard) return '?';
+template<int Rows, int Cols>
+char BasicBoard<Rows, Cols>::charAt(int row, int col) const {
+    if (isBlindBoard && Dims::isBlinded(row, col)) return '?';
     return grid[row][col].getSymbol();
 }
 
 // For the textObserver to get the next Block
-Block* Board::getNextBlock() { return nextBlock.get(); }
+template<int Rows, int Cols>
+Block* BasicBoard<Rows, Cols>::getNextBlock() { return nextBlock.get(); }
 
-void Board::setNewCurrentBlock(std::shared_ptr<Block> block) {
-    currentBlock = block;
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::setNewCurrentBlock(BlockRef block) {
+    // the Tiles of the Block it replaces, if they are on the grid, have settled
+    currentBlock = std::move(block);
+    blockPlaced = false;
 }
-void Board::setNewNextBlock(std::shared_ptr<Block> block) {
-    nextBlock = block;
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::setNewNextBlock(BlockRef block) {
+    nextBlock = std::move(block);
 }
 
-std::shared_ptr<Block> Board::getBoardNextBlock() { return nextBlock; }
+template<int Rows, int Cols>
+BlockRef BasicBoard<Rows, Cols>::getBoardNextBlock() { return nextBlock; }
 
 // Check whether a Block can be placed at the starting position
-bool Board::tryPlaceBlock() {
+template<int Rows, int Cols>
+bool BasicBoard<Rows, Cols>::tryPlaceBlock() {
     for (const auto& tile : currentBlock->getCoords()) {
-        size_t x = tile.first;
-        size_t y = tile.second;
-        if (x < 0 || x >= grid[0].size() || y < 0 || y >= grid.size()) {
+        int x = tile.first;
+        int y = tile.second;
+        if (x < 0 || x >= COLS || y < 0 || y >= ROWS) {
             return false; // Invalid position on the board
         }
         if (grid[y][x].getIsOccupied()) {
@@ -47,29 +60,35 @@ bool Board::tryPlaceBlock() {
     return true; // All Tiles not occupied
 }
 // Place the Block on the Board
-void Board::placeBlock() {
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::placeBlock() {
     for (const auto& tile : currentBlock->getCoords()) {
-        grid[tile.second][tile.first] = currentBlock->getBlockTile(); // Place the new Tile
+        setTile(tile.second, tile.first, currentBlock->getBlockTile()); // Place the new Tile
     }
+    blockPlaced = true;
 }
 
 // Remove the Bloack on the Board (does not modify the Block's coordinates)
-void Board::removeBlock(bool pointOffset) {
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::removeBlock(bool pointOffset) {
     // offset the points if needed
     if (pointOffset) currentBlock->getPlayer()->offsetScoreBlock(currentBlock->getOrigLvl());
 
     for (const auto& tile : currentBlock->getCoords()) {
-        grid[tile.second][tile.first] = Tile(' '); // Replace with Blank Tile
+        setTile(tile.second, tile.first, Tile(' ')); // Replace with Blank Tile
     }
+    blockPlaced = false;
 }
 
 // Check whether a Block can be rotated
-bool Board::tryRotateBlock(string dir) {
-    std::vector<std::pair<int, int>> newCoords = currentBlock->computeRotatedCoords(dir); // Obtain the new coords
+template<int Rows, int Cols>
+bool BasicBoard<Rows, Cols>::tryRotateBlock(string dir) {
+    Profile::Scope profile{Profile::TryRotateBlock};
+    BlockCoords newCoords = currentBlock->computeRotatedCoords(dir); // Obtain the new coords
     for (const auto& tile : newCoords) {
-        size_t x = tile.first;
-        size_t y = tile.second;
-        if (x < 0 || x >= grid[0].size() || y < 0 || y >= grid.size()) {
+        int x = tile.first;
+        int y = tile.second;
+        if (x < 0 || x >= COLS || y < 0 || y >= ROWS) {
             return false; // Invalid position on the board
         }
         if (grid[y][x].getIsOccupied()) {
@@ -88,7 +107,8 @@ bool Board::tryRotateBlock(string dir) {
     return true; // All Tiles not occupied
 }
 // Rotate the Block
-void Board::rotateBlock(string dir) {
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::rotateBlock(string dir) {
     if (tryRotateBlock(dir)) {
         removeBlock(false);
         currentBlock->rotate(dir);
@@ -97,12 +117,14 @@ void Board::rotateBlock(string dir) {
 }
 
 // Check whether the Block can be moved in specified direction
-bool Board::tryMoveBlock(string dir) {
-    std::vector<std::pair<int, int>> newCoords = currentBlock->computeMovedCoords(dir); // Obtain the new coords
+template<int Rows, int Cols>
+bool BasicBoard<Rows, Cols>::tryMoveBlock(string dir) {
+    Profile::Scope profile{Profile::TryMoveBlock};
+    BlockCoords newCoords = currentBlock->computeMovedCoords(dir); // Obtain the new coords
     for (const auto& tile : newCoords) {
-        size_t x = tile.first;
-        size_t y = tile.second;
-        if (x < 0 || x >= grid[0].size() || y < 0 || y >= grid.size()) {
+        int x = tile.first;
+        int y = tile.second;
+        if (x < 0 || x >= COLS || y < 0 || y >= ROWS) {
             return false; // Invalid position on the board
         }
         if (grid[y][x].getIsOccupied()) {
@@ -121,7 +143,8 @@ bool Board::tryMoveBlock(string dir) {
     return true; // All Tiles not occupied
 }
 // Move the Block (if tryMoveBlock returns true)
-void Board::moveBlock(string dir) {
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::moveBlock(string dir) {
     if (tryMoveBlock(dir)) {
         removeBlock(false);
         currentBlock->move(dir);
@@ -130,7 +153,9 @@ void Board::moveBlock(string dir) {
 }
 
 // Drop the Block
-void Board::dropBlock() {
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::dropBlock() {
+    Profile::Scope profile{Profile::DropBlock};
     while (tryMoveBlock("d")) {
         moveBlock("d");
     }
@@ -138,7 +163,12 @@ void Board::dropBlock() {
 
 // [TODO]
 // Clear any full rows and shift above Tile downwards if needed
-int Board::clearFullRows() {
+template<int Rows, int Cols>
+int BasicBoard<Rows, Cols>::clearFullRows() {
+    Profile::Scope profile{Profile::ClearFullRows};
+    Trace::Span trace{"game", "line clear"};
+    // rows are only cleared once the current Block has landed
+    blockPlaced = false;
     int clearedRows = 0;
     int row = ROWS-1;
     while (row > 0) {
@@ -163,19 +193,19 @@ int Board::clearFullRows() {
 
 // [TODO]
 // Shift all Tiles above and including row i down 1
-void Board::shiftDown(int i){
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::shiftDown(int i){
     Tile blankTile{' ', false, nullptr};
     for (int j = i; j > 0; --j) {
         for (int k = 0; k < COLS; k++) {
-            grid[j][k] = grid[j-1][k];
-            grid[j-1][k] = blankTile;
+            setTile(j, k, grid[j-1][k]);
+            setTile(j-1, k, blankTile);
         }
     }
 }
 
-void Board::clearBoard() {
-    grid.clear();
-    grid.resize(ROWS, std::vector<Tile>(COLS));
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::clearBoard() {
     // Set all to blank
     for (int i = 0; i < ROWS; ++i) {
         for (int j = 0; j < COLS; ++j) {
@@ -183,24 +213,113 @@ void Board::clearBoard() {
                 grid[i][j] = blankTile;
         }
     }
+    hash = 0; // Nothing left to hash
+    blockPlaced = false;
+    rowMasks.fill(0);
+    dirtyCols = fullRowMask<Cols>;
+    dirtyRows = (1u << ROWS) - 1;
 }
 
-bool Board::dropStarBlock(Player* player) {
-    std::shared_ptr<Block> star = std::make_shared<StarBlock>(player);
-    std::shared_ptr<Block> temp = currentBlock; // temporarily hold the currentBlock to not lose it
-    currentBlock = star;
+template<int Rows, int Cols>
+bool BasicBoard<Rows, Cols>::dropStarBlock(BlockRef star) {
+    BlockRef temp = std::move(currentBlock); // temporarily hold the currentBlock to not lose it
+    bool tempPlaced = blockPlaced;
+    currentBlock = std::move(star);
     if (!tryPlaceBlock()) {
-        currentBlock = temp;
+        currentBlock = std::move(temp);
         return false;
     }
     else {
         placeBlock();
         dropBlock();
-        currentBlock = temp;
+        // the StarBlock settles right away
+        currentBlock = std::move(temp);
+        blockPlaced = tempPlaced;
         return true;
     }
 }
 
-void Board::setBlind(const bool blind) { isBlindBoard = blind; }
+// Replace the Tile at (row, col), XORing its key into the hash if it gets occupied or freed
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::setTile(int row, int col, const Tile &tile) {
+    if (tile.getIsOccupied() != grid[row][col].getIsOccupied()) hash ^= BasicZobrist<Rows, Cols>::key(row, col);
 
-bool Board::isBlind() { return isBlindBoard; }
+    if (tile.getIsOccupied()) rowMasks[row] |= 1 << col;
+    else rowMasks[row] &= ~(1 << col);
+
+    dirtyCols |= 1 << col;
+    dirtyRows |= 1u << row;
+    grid[row][col] = tile;
+}
+
+template<int Rows, int Cols>
+uint64_t BasicBoard<Rows, Cols>::getHash() const {
+    uint64_t res = hash;
+    // the current Block has not settled yet
+    if (blockPlaced) {
+        for (const auto& tile : currentBlock->getCoords()) res ^= BasicZobrist<Rows, Cols>::key(tile.second, tile.first);
+    }
+    return res;
+}
+
+template<int Rows, int Cols>
+const BasicBoardFeatures<Rows, Cols> &BasicBoard<Rows, Cols>::getFeatures() const {
+    if (dirtyCols || dirtyRows) {
+        for (int j = 0; j < COLS; ++j) {
+            if (dirtyCols & (1 << j)) features.updateColumn(rowMasks, j);
+        }
+        for (int i = 0; i < ROWS; ++i) {
+            if (dirtyRows & (1u << i)) features.updateRow(rowMasks, i);
+        }
+        features.summarize();
+        dirtyCols = 0;
+        dirtyRows = 0;
+    }
+    return features;
+}
+
+template<int Rows, int Cols>
+BasicBoardFeatures<Rows, Cols> BasicBoard<Rows, Cols>::evaluatePlacement(const std::vector<std::pair<int, int>> &coords) const {
+    BasicRowMasks<Rows> rows = rowMasks;
+    uint16_t changedCols = 0;
+    uint32_t changedRows = 0;
+    // Take the current Block off the Board and put it at 'coords' instead
+    if (currentBlock) {
+        for (const auto& tile : currentBlock->getCoords()) {
+            rows[tile.second] &= ~(1 << tile.first);
+            changedCols |= 1 << tile.first;
+            changedRows |= 1u << tile.second;
+        }
+    }
+    for (const auto& tile : coords) {
+        rows[tile.second] |= 1 << tile.first;
+        changedCols |= 1 << tile.first;
+        changedRows |= 1u << tile.second;
+    }
+    int cleared = ::clearFullRows<Rows, Cols>(rows);
+    BasicBoardFeatures<Rows, Cols> res;
+    // Clearing rows moves everything above them, otherwise only the columns and
+    // rows the Block left or landed in differ from the Board's own features
+    if (cleared) res = BasicBoardFeatures<Rows, Cols>::fromRows(rows);
+    else {
+        res = getFeatures();
+        for (int j = 0; j < COLS; ++j) {
+            if (changedCols & (1 << j)) res.updateColumn(rows, j);
+        }
+        for (int i = 0; i < ROWS; ++i) {
+            if (changedRows & (1u << i)) res.updateRow(rows, i);
+        }
+        res.summarize();
+    }
+    res.linesCleared = cleared;
+    return res;
+}
+
+template<int Rows, int Cols>
+void BasicBoard<Rows, Cols>::setBlind(const bool blind) { isBlindBoard = blind; }
+
+template<int Rows, int Cols>
+bool BasicBoard<Rows, Cols>::isBlind() { return isBlindBoard; }
+
+template class BasicBoard<StandardDims::ROWS, StandardDims::COLS>;
+template class BasicBoard<WideDims::ROWS, WideDims::COLS>;
@@ -0,0 +1,422 @@
+#include "boardBatch.h"
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOARD_BATCH_X86
+#endif
+
+// The kernels work on one chunk at a time, 'rows[r][l]' being row 'r' of the
+// Board in lane 'l', and write one result per lane
+
+using ChunkRows = uint16_t[MASK_ROWS][BoardBatch::LANES];
+constexpr int LANES = BoardBatch::LANES;
+
+// Scalar kernels
+
+static void fullRowsScalar(const ChunkRows &rows, uint32_t *res) {
+    for (int l = 0; l < LANES; ++l) {
+        res[l] = 0;
+
+        for (int r = 0; r < MASK_ROWS; ++r) {
+            if (rows[r][l] == FULL_ROW_MASK) res[l] |= 1u << r;
+        }
+    }
+}
+
+static void clearFullRowsScalar(ChunkRows &rows, int *res) {
+    for (int l = 0; l < LANES; ++l) {
+        RowMasks board;
+
+        for (int r = 0; r < MASK_ROWS; ++r) board[r] = rows[r][l];
+
+        res[l] = clearFullRows(board);
+
+        for (int r = 0; r < MASK_ROWS; ++r) rows[r][l] = board[r];
+    }
+}
+
+static void columnHeightsScalar(const ChunkRows &rows, std::array<uint8_t, MASK_COLS> *res) {
+    for (int l = 0; l < LANES; ++l) {
+        for (int c = 0; c < MASK_COLS; ++c) {
+            int top = 0;
+
+            while (top < MASK_ROWS && !(rows[top][l] & (1 << c))) ++top;
+
+            res[l][c] = MASK_ROWS - top;
+        }
+    }
+}
+
+static void holesScalar(const ChunkRows &rows, int *res) {
+    for (int l = 0; l < LANES; ++l) {
+        unsigned seen = 0;
+        res[l] = 0;
+
+        for (int r = 0; r < MASK_ROWS; ++r) {
+            res[l] += std::popcount(seen & ~static_cast<unsigned>(rows[r][l]));
+            seen |= rows[r][l];
+        }
+    }
+}
+
+#ifdef BOARD_BATCH_X86
+
+// SSE2 kernels, on the 8 lanes starting at 'off'. SSE2 is part of x86-64, so
+// these need no special target.
+
+static __m128i popcount16Sse2(__m128i x) {
+    x = _mm_sub_epi16(x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi16(0x5555)));
+    x = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi16(0x3333)),
+                      _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi16(0x3333)));
+    x = _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 4)), _mm_set1_epi16(0x0F0F));
+    return _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), _mm_set1_epi16(0x001F));
+}
+
+static __m128i loadSse2(const ChunkRows &rows, int r, int off) {
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(&rows[r][off]));
+}
+
+static void fullRowsSse2(const ChunkRows &rows, int off, uint32_t *res) {
+    const __m128i full = _mm_set1_epi16(FULL_ROW_MASK);
+    // rows 0 to 15 and rows 16 and up are gathered separately, as a lane only
+    // has 16 bits
+    __m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        __m128i isFull = _mm_cmpeq_epi16(loadSse2(rows, r, off), full);
+
+        if (r < 16) low = _mm_or_si128(low, _mm_and_si128(isFull, _mm_set1_epi16(1 << r)));
+        else high = _mm_or_si128(high, _mm_and_si128(isFull, _mm_set1_epi16(1 << (r - 16))));
+    }
+
+    alignas(16) uint16_t lowBits[8], highBits[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lowBits), low);
+    _mm_store_si128(reinterpret_cast<__m128i *>(highBits), high);
+
+    for (int l = 0; l < 8; ++l) res[off + l] = lowBits[l] | static_cast<uint32_t>(highBits[l]) << 16;
+}
+
+// Board::clearFullRows removes every full row below the top one, and also the
+// top row if it is full and at least one other row was cleared, since it then
+// moves down to a row that is checked. Going from the top row down, removing a
+// row only moves the rows above it, so every row still holds its original
+// contents when it is reached and can be removed with a branch-free blend.
+static void clearFullRowsSse2(ChunkRows &rows, int off, int *res) {
+    const __m128i full = _mm_set1_epi16(FULL_ROW_MASK);
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i row[MASK_ROWS], isFull[MASK_ROWS];
+    __m128i anyFull = _mm_setzero_si128(), cleared = _mm_setzero_si128();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        row[r] = loadSse2(rows, r, off);
+        isFull[r] = _mm_cmpeq_epi16(row[r], full);
+
+        if (r > 0) anyFull = _mm_or_si128(anyFull, isFull[r]);
+    }
+
+    isFull[0] = _mm_and_si128(isFull[0], anyFull);
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        cleared = _mm_add_epi16(cleared, _mm_and_si128(isFull[r], one));
+
+        for (int j = r; j > 0; --j) {
+            row[j] = _mm_or_si128(_mm_and_si128(isFull[r], row[j - 1]), _mm_andnot_si128(isFull[r], row[j]));
+        }
+
+        row[0] = _mm_andnot_si128(isFull[r], row[0]);
+    }
+
+    alignas(16) uint16_t counts[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(counts), cleared);
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        _mm_store_si128(reinterpret_cast<__m128i *>(&rows[r][off]), row[r]);
+    }
+
+    for (int l = 0; l < 8; ++l) res[off + l] = counts[l];
+}
+
+// A column is as high as the number of rows at or below its highest Tile, so
+// its height is the number of rows for which the Tiles seen from the top so far
+// include that column
+static void columnHeightsSse2(const ChunkRows &rows, int off, std::array<uint8_t, MASK_COLS> *res) {
+    __m128i heights[MASK_COLS];
+    __m128i seen = _mm_setzero_si128();
+
+    for (int c = 0; c < MASK_COLS; ++c) heights[c] = _mm_setzero_si128();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        seen = _mm_or_si128(seen, loadSse2(rows, r, off));
+
+        for (int c = 0; c < MASK_COLS; ++c) {
+            __m128i bit = _mm_set1_epi16(1 << c);
+            // the comparison is all ones (-1) when the column was seen
+            heights[c] = _mm_sub_epi16(heights[c], _mm_cmpeq_epi16(_mm_and_si128(seen, bit), bit));
+        }
+    }
+
+    for (int c = 0; c < MASK_COLS; ++c) {
+        alignas(16) uint16_t h[8];
+        _mm_store_si128(reinterpret_cast<__m128i *>(h), heights[c]);
+
+        for (int l = 0; l < 8; ++l) res[off + l][c] = h[l];
+    }
+}
+
+static void holesSse2(const ChunkRows &rows, int off, int *res) {
+    __m128i seen = _mm_setzero_si128(), holes = _mm_setzero_si128();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        __m128i row = loadSse2(rows, r, off);
+        holes = _mm_add_epi16(holes, popcount16Sse2(_mm_andnot_si128(row, seen)));
+        seen = _mm_or_si128(seen, row);
+    }
+
+    alignas(16) uint16_t counts[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(counts), holes);
+
+    for (int l = 0; l < 8; ++l) res[off + l] = counts[l];
+}
+
+// AVX2 kernels, the same as the SSE2 ones on all 16 lanes at once. They are
+// compiled for AVX2 on their own and only called when the CPU supports it.
+
+#define AVX2_KERNEL __attribute__((target("avx2")))
+
+AVX2_KERNEL static __m256i popcount16Avx2(__m256i x) {
+    x = _mm256_sub_epi16(x, _mm256_and_si256(_mm256_srli_epi16(x, 1), _mm256_set1_epi16(0x5555)));
+    x = _mm256_add_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x3333)),
+                         _mm256_and_si256(_mm256_srli_epi16(x, 2), _mm256_set1_epi16(0x3333)));
+    x = _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 4)), _mm256_set1_epi16(0x0F0F));
+    return _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), _mm256_set1_epi16(0x001F));
+}
+
+AVX2_KERNEL static __m256i loadAvx2(const ChunkRows &rows, int r) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(rows[r]));
+}
+
+AVX2_KERNEL static void fullRowsAvx2(const ChunkRows &rows, uint32_t *res) {
+    const __m256i full = _mm256_set1_epi16(FULL_ROW_MASK);
+    __m256i low = _mm256_setzero_si256(), high = _mm256_setzero_si256();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        __m256i isFull = _mm256_cmpeq_epi16(loadAvx2(rows, r), full);
+
+        if (r < 16) low = _mm256_or_si256(low, _mm256_and_si256(isFull, _mm256_set1_epi16(1 << r)));
+        else high = _mm256_or_si256(high, _mm256_and_si256(isFull, _mm256_set1_epi16(1 << (r - 16))));
+    }
+
+    alignas(32) uint16_t lowBits[LANES], highBits[LANES];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lowBits), low);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(highBits), high);
+
+    for (int l = 0; l < LANES; ++l) res[l] = lowBits[l] | static_cast<uint32_t>(highBits[l]) << 16;
+}
+
+AVX2_KERNEL static void clearFullRowsAvx2(ChunkRows &rows, int *res) {
+    const __m256i full = _mm256_set1_epi16(FULL_ROW_MASK);
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i row[MASK_ROWS], isFull[MASK_ROWS];
+    __m256i anyFull = _mm256_setzero_si256(), cleared = _mm256_setzero_si256();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        row[r] = loadAvx2(rows, r);
+        isFull[r] = _mm256_cmpeq_epi16(row[r], full);
+
+        if (r > 0) anyFull = _mm256_or_si256(anyFull, isFull[r]);
+    }
+
+    isFull[0] = _mm256_and_si256(isFull[0], anyFull);
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        cleared = _mm256_add_epi16(cleared, _mm256_and_si256(isFull[r], one));
+
+        for (int j = r; j > 0; --j) row[j] = _mm256_blendv_epi8(row[j], row[j - 1], isFull[r]);
+
+        row[0] = _mm256_andnot_si256(isFull[r], row[0]);
+    }
+
+    alignas(32) uint16_t counts[LANES];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(counts), cleared);
+
+    for (int r = 0; r < MASK_ROWS; ++r) _mm256_store_si256(reinterpret_cast<__m256i *>(rows[r]), row[r]);
+
+    for (int l = 0; l < LANES; ++l) res[l] = counts[l];
+}
+
+AVX2_KERNEL static void columnHeightsAvx2(const ChunkRows &rows, std::array<uint8_t, MASK_COLS> *res) {
+    __m256i heights[MASK_COLS];
+    __m256i seen = _mm256_setzero_si256();
+
+    for (int c = 0; c < MASK_COLS; ++c) heights[c] = _mm256_setzero_si256();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        seen = _mm256_or_si256(seen, loadAvx2(rows, r));
+
+        for (int c = 0; c < MASK_COLS; ++c) {
+            __m256i bit = _mm256_set1_epi16(1 << c);
+            heights[c] = _mm256_sub_epi16(heights[c], _mm256_cmpeq_epi16(_mm256_and_si256(seen, bit), bit));
+        }
+    }
+
+    for (int c = 0; c < MASK_COLS; ++c) {
+        alignas(32) uint16_t h[LANES];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(h), heights[c]);
+
+        for (int l = 0; l < LANES; ++l) res[l][c] = h[l];
+    }
+}
+
+AVX2_KERNEL static void holesAvx2(const ChunkRows &rows, int *res) {
+    __m256i seen = _mm256_setzero_si256(), holes = _mm256_setzero_si256();
+
+    for (int r = 0; r < MASK_ROWS; ++r) {
+        __m256i row = loadAvx2(rows, r);
+        holes = _mm256_add_epi16(holes, popcount16Avx2(_mm256_andnot_si256(row, seen)));
+        seen = _mm256_or_si256(seen, row);
+    }
+
+    alignas(32) uint16_t counts[LANES];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(counts), holes);
+
+    for (int l = 0; l < LANES; ++l) res[l] = counts[l];
+}
+
+#endif
+
+BoardBatch::BoardBatch(): count{0}, kernels{bestKernels()} {}
+
+BoardBatch::Kernels BoardBatch::bestKernels() {
+#ifdef BOARD_BATCH_X86
+    static const Kernels best = __builtin_cpu_supports("avx2") ? Kernels::AVX2 : Kernels::SSE2;
+    return best;
+#else
+    return Kernels::Scalar;
+#endif
+}
+
+const char *BoardBatch::kernelsName(Kernels k) {
+    switch (k) {
+        case Kernels::AVX2: return "avx2";
+        case Kernels::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void BoardBatch::useKernels(Kernels k) {
+    kernels = k <= bestKernels() ? k : bestKernels();
+}
+
+BoardBatch::Kernels BoardBatch::getKernels() const { return kernels; }
+
+size_t BoardBatch::size() const { return count; }
+
+void BoardBatch::clear() {
+    chunks.clear();
+    count = 0;
+}
+
+void BoardBatch::push(const RowMasks &rows) {
+    // unused lanes of the last chunk are empty Boards, whose results are ignored
+    if (count % LANES == 0) chunks.push_back(Chunk{});
+
+    Chunk &chunk = chunks.back();
+
+    for (int r = 0; r < MASK_ROWS; ++r) chunk.rows[r][count % LANES] = rows[r];
+
+    ++count;
+}
+
+RowMasks BoardBatch::get(size_t i) const {
+    RowMasks res;
+    const Chunk &chunk = chunks[i / LANES];
+
+    for (int r = 0; r < MASK_ROWS; ++r) res[r] = chunk.rows[r][i % LANES];
+
+    return res;
+}
+
+void BoardBatch::fullRows(std::vector<uint32_t> &res) const {
+    res.resize(chunks.size() * LANES);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        uint32_t *out = &res[i * LANES];
+#ifdef BOARD_BATCH_X86
+        if (kernels == Kernels::AVX2) {
+            fullRowsAvx2(chunks[i].rows, out);
+            continue;
+        } else if (kernels == Kernels::SSE2) {
+            fullRowsSse2(chunks[i].rows, 0, out);
+            fullRowsSse2(chunks[i].rows, 8, out);
+            continue;
+        }
+#endif
+        fullRowsScalar(chunks[i].rows, out);
+    }
+
+    res.resize(count);
+}
+
+void BoardBatch::clearFullRows(std::vector<int> &res) {
+    res.resize(chunks.size() * LANES);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        int *out = &res[i * LANES];
+#ifdef BOARD_BATCH_X86
+        if (kernels == Kernels::AVX2) {
+            clearFullRowsAvx2(chunks[i].rows, out);
+            continue;
+        } else if (kernels == Kernels::SSE2) {
+            clearFullRowsSse2(chunks[i].rows, 0, out);
+            clearFullRowsSse2(chunks[i].rows, 8, out);
+            continue;
+        }
+#endif
+        clearFullRowsScalar(chunks[i].rows, out);
+    }
+
+    res.resize(count);
+}
+
+void BoardBatch::columnHeights(std::vector<std::array<uint8_t, MASK_COLS>> &res) const {
+    res.resize(chunks.size() * LANES);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        std::array<uint8_t, MASK_COLS> *out = &res[i * LANES];
+#ifdef BOARD_BATCH_X86
+        if (kernels == Kernels::AVX2) {
+            columnHeightsAvx2(chunks[i].rows, out);
+            continue;
+        } else if (kernels == Kernels::SSE2) {
+            columnHeightsSse2(chunks[i].rows, 0, out);
+            columnHeightsSse2(chunks[i].rows, 8, out);
+            continue;
+        }
+#endif
+        columnHeightsScalar(chunks[i].rows, out);
+    }
+
+    res.resize(count);
+}
+
+void BoardBatch::holes(std::vector<int> &res) const {
+    res.resize(chunks.size() * LANES);
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        int *out = &res[i * LANES];
+#ifdef BOARD_BATCH_X86
+        if (kernels == Kernels::AVX2) {
+            holesAvx2(chunks[i].rows, out);
+            continue;
+        } else if (kernels == Kernels::SSE2) {
+            holesSse2(chunks[i].rows, 0, out);
+            holesSse2(chunks[i].rows, 8, out);
+            continue;
+        }
+#endif
+        holesScalar(chunks[i].rows, out);
+    }
+
+    res.resize(count);
+}
@@ -0,0 +1,77 @@
+#include "boardFeatures.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+template<int Rows, int Cols>
+void BasicBoardFeatures<Rows, Cols>::updateColumn(const Masks &rows, int col) {
+    uint16_t bit = 1 << col;
+    int top = 0;
+
+    while (top < Rows && !(rows[top] & bit)) ++top;
+
+    heights[col] = Rows - top;
+    holes[col] = 0;
+
+    for (int i = top + 1; i < Rows; ++i) {
+        if (!(rows[i] & bit)) ++holes[col];
+    }
+}
+
+template<int Rows, int Cols>
+void BasicBoardFeatures<Rows, Cols>::updateRow(const Masks &rows, int row) {
+    // the row with a wall added on each side, so each pair of neighbouring
+    // bits that differ is one transition
+    unsigned walled = 1u | static_cast<unsigned>(rows[row]) << 1 | 1u << (Cols + 1);
+
+    transitions[row] = std::popcount((walled ^ (walled >> 1)) & ((1u << (Cols + 1)) - 1));
+}
+
+template<int Rows, int Cols>
+void BasicBoardFeatures<Rows, Cols>::summarize() {
+    aggregateHeight = maxHeight = totalHoles = bumpiness = wellDepths = rowTransitions = 0;
+
+    for (int j = 0; j < Cols; ++j) {
+        aggregateHeight += heights[j];
+        maxHeight = std::max(maxHeight, heights[j]);
+        totalHoles += holes[j];
+
+        if (j + 1 < Cols) bumpiness += std::abs(heights[j] - heights[j + 1]);
+
+        int left = j > 0 ? heights[j - 1] : Rows;
+        int right = j + 1 < Cols ? heights[j + 1] : Rows;
+
+        if (heights[j] < std::min(left, right)) wellDepths += std::min(left, right) - heights[j];
+    }
+
+    for (int i = 0; i < Rows; ++i) rowTransitions += transitions[i];
+}
+
+template<int Rows, int Cols>
+BasicBoardFeatures<Rows, Cols> BasicBoardFeatures<Rows, Cols>::fromRows(const Masks &rows) {
+    BasicBoardFeatures res;
+
+    for (int j = 0; j < Cols; ++j) res.updateColumn(rows, j);
+    for (int i = 0; i < Rows; ++i) res.updateRow(rows, i);
+
+    res.summarize();
+
+    return res;
+}
+
+// Weights of the same four features found by a genetic algorithm in Yiyuan
+// Lee's "Tetris AI -- The (Near) Perfect Bot" (2013), on a 10 by 22 board
+// without Levels. They are a starting point, not tuned for Biquadris.
+static const double HEIGHT_WEIGHT = -0.510066;
+static const double LINES_WEIGHT = 0.760666;
+static const double HOLES_WEIGHT = -0.35663;
+static const double BUMPINESS_WEIGHT = -0.184483;
+
+template<int Rows, int Cols>
+double BasicBoardFeatures<Rows, Cols>::score() const {
+    return HEIGHT_WEIGHT * aggregateHeight + LINES_WEIGHT * linesCleared
+           + HOLES_WEIGHT * totalHoles + BUMPINESS_WEIGHT * bumpiness;
+}
+
+template struct BasicBoardFeatures<StandardDims::ROWS, StandardDims::COLS>;
+template struct BasicBoardFeatures<WideDims::ROWS, WideDims::COLS>;
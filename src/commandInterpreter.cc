@@ -1,14 +1,34 @@
 #include "commandInterpreter.h"
+#include "profile.h"
+#include "script.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <sstream>
 
 using namespace std;
 
 const int MAX_LEVEL = 4;
 
+static const char* const SPEC_ACT_PROMPT = "Choose a special action (blind, heavy, force <blockType>): ";
+
+// Input is scanned by hand rather than with std::regex, which recurses once
+// per character and so runs out of stack on a long enough line.
+static const char* const WHITESPACE = " \t\n\v\f\r";
+
+// whether 'word' is 'name' or the start of it, ignoring case
+static bool abbreviates(const string& word, const string& name) {
+    if (word.empty() || word.size() > name.size()) return false;
+
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(word[i])) != name[i]) return false;
+    }
+    return true;
+}
+
 void CommandInterpreter::renameCommand(string& commandName, string& newName) {
     auto it = commands.find(commandName);
     if (it == commands.end()) {
@@ -22,26 +42,27 @@ void CommandInterpreter::renameCommand(string& commandName, string& newName) {
     commands.erase(it);
 }
 
-bool CommandInterpreter::createMacro() {
+bool CommandInterpreter::createMacro(std::istream& in) {
     string name;
     string macroCommands;
-    cout << "Defining a Macro. Enter macro name: ";
-    if (!(cin >> name)) {
+    *out << "Defining a Macro. Enter macro name: ";
+    if (!(in >> name)) {
         return false;
     }
-    cout << "Macro will be named \"" << name
+    *out << "Macro will be named \"" << name
          << "\". Enter commands, using their full names. Commands multipliers are accepted (e.g. 3left 2clockwise): "
          << endl;
-    std::cin.ignore(1, '\n');
-    if (!(getline(cin, macroCommands))) {
+    in.ignore(1, '\n');
+    if (!(getline(in, macroCommands))) {
         return false;
     }
     commands[name] = macroCommands;
-    cout << "Macro created: " << name << "->" << macroCommands << endl;
+    macros[macroCommands] = splitCommands(macroCommands);
+    *out << "Macro created: " << name << "->" << macroCommands << endl;
     return true;
 }
 
-bool CommandInterpreter::isBuiltinCommand(string& command) const {
+bool CommandInterpreter::isBuiltinCommand(const string& command) const {
     for (string s : builtinCommands) {
         if (command == s) {
             return true;
@@ -50,7 +71,33 @@ bool CommandInterpreter::isBuiltinCommand(string& command) const {
     return false;
 }
 
-CommandInterpreter::CommandInterpreter() {
+Commands CommandInterpreter::commandsFor(const string& match, int multiplier) const {
+    if (isBuiltinCommand(match)) return {{match, multiplier}};
+
+    // a macro, whose commands have their own multipliers
+    auto it = macros.find(match);
+    return it == macros.end() ? Commands{} : it->second;
+}
+
+Commands CommandInterpreter::splitCommands(const string& text) {
+    Commands result;
+    istringstream iss{text};
+    string word;
+
+    while (iss >> word) {
+        size_t digits = 0;
+        while (digits < word.size() && isdigit(static_cast<unsigned char>(word[digits]))) ++digits;
+
+        // more digits than an int holds are no multiplier
+        if (digits > 9) continue;
+
+        result.push_back({word.substr(digits), digits > 0 ? stoi(word.substr(0, digits)) : 1});
+    }
+
+    return result;
+}
+
+CommandInterpreter::CommandInterpreter(): out{&cout} {
     builtinCommands = {
         "left",
         "right",
@@ -80,117 +127,250 @@ CommandInterpreter::CommandInterpreter() {
     }
 }
 
-string CommandInterpreter::parseCommand(std::istream& in, string& filename, bool bonus) {
+bool CommandInterpreter::lookupCommand(const string& first, int& multiplier, string& commandName,
+                                       string& match, ostream& out) const {
+    // a multiplier's digits, then the letters of the command
+    size_t digits = 0;
+    while (digits < first.size() && isdigit(static_cast<unsigned char>(first[digits]))) ++digits;
+
+    bool letters = digits < first.size();
+    for (size_t i = digits; i < first.size(); ++i) {
+        if (!isalpha(static_cast<unsigned char>(first[i]))) letters = false;
+    }
+
+    // more digits than an int holds are no multiplier either
+    if (!letters || digits > 9) {
+        out << "Invalid input format: \"" << first << "\". Type 'help' for a list of commands." << std::endl;
+        return false;
+    }
+
+    multiplier = 1;
+
+    // check if a multiplier is provided
+    if (digits > 0) {
+        multiplier = stoi(first.substr(0, digits));
+    }
+
+    commandName = first.substr(digits);
+    match = "";
+    // try to match the command name to a registered command
+    for (const auto& [key, value] : commands) {
+        if (key.find(commandName) == 0) {  // check if first is a prefix of a command
+            if (!match.empty()) {
+                // more than one command matches
+                out << "Ambiguous command: \"" << commandName << "\". Type 'help' for a list of commands." << endl;
+                return false;
+            }
+            match = value;  // Set the match to the value
+        }
+    }
+    // If we didn't find a command, reprompt
+    if (match.empty()) {
+        out << "No command found: " << commandName << std::endl;
+    }
+
+    return true;
+}
+
+Commands CommandInterpreter::parseCommand(std::istream& in, string& filename, bool bonus) {
     string input;
 
-    if (!(getline(in, input))) {
-        return "EOF";
+    {
+        Trace::Span trace{"input", "input wait"};
+
+        if (!(getline(in, input))) {
+            return {{"EOF", 1}};
+        }
     }
 
-    if (input == "-bonus") return "bonus";
+    // only the parsing, not the wait for the line
+    Profile::Scope profile{Profile::ParseCommand};
+    Trace::Span trace{"game", "parse"};
+
+    return parseLine(input, filename, bonus, in);
+}
+
+Commands CommandInterpreter::parseLine(const string& input, string& filename, bool bonus, std::istream& in) {
+    if (input == "-bonus") return {{"bonus", 1}};
 
     istringstream iss{input};
     string first, second, third;
     iss >> first >> second >> third;
 
-    regex commandRegex(R"((\d*)([a-zA-Z]+))");
-    smatch matches;
-    if (regex_match(first, matches, commandRegex)) {
-        int multiplier = 1;
-        string commandName;
+    int multiplier;
+    string commandName, match;
 
-        // check if a multiplier is provided
-        if (matches[1].matched && !matches[1].str().empty()) {
-            multiplier = stoi(matches[1].str());
-        }
+    if (!lookupCommand(first, multiplier, commandName, match, *out)) return {};
 
-        commandName = matches[2].str();
-        // try to match the command name to a registered command
-        string match;
-        for (const auto& [key, value] : commands) {
-            if (key.find(commandName) == 0) {  // check if first is a prefix of a command
-                if (!match.empty()) {
-                    // more than one command matches
-                    cout << "Ambiguous command: \"" << commandName << "\". Type 'help' for a list of commands." << endl;
-                    return "";
-                }
-                match = value;  // Set the match to the value
-            }
-        }
-        // If we didn't find a command, reprompt
-        if (match.empty()) {
-            std::cout << "No command found: " << commandName << std::endl;
+    // check for commands with multiple arguments or special commands
+    if (match == "sequence" || match == "norandom") {
+        filename = second;
+    } else if (match == "rename" && bonus) {
+        try {
+            renameCommand(second, third);
+            *out << "Command renamed from \"" << second << "\" to \"" << third << "\"\n";
+        } catch (const std::exception& e) {
+            *out << e.what() << std::endl;
         }
-        // check for commands with multiple arguments or special commands
-        if (match == "sequence" || match == "norandom") {
-            filename = second;
-        } else if (match == "rename" && bonus) {
-            try {
-                renameCommand(second, third);
-                std::cout << "Command renamed from \"" << second << "\" to \"" << third << "\"\n";
-            } catch (const std::exception& e) {
-                std::cout << e.what() << std::endl;
-            }
-        } else if (match == "rename") { 
-            std::cout << "No command found: " << commandName << std::endl;
-            return "";
-        } else if (match == "macro" && bonus) {
-            if (!createMacro()) {
-                return "EOF";
-            }
-            return "";
-        } else if (match == "macro") {
-            std::cout << "No command found: " << commandName << std::endl;
-            return "";
-        } else if (match == "help") {
-            cout << "Available commands:\n";
-            for (const auto& [key, _] : commands) {
-                cout << "- " << key << "\n";
-            }
-            cout << "You can also prefix commands with a number (e.g., '3left' to move left three times).\n";
+    } else if (match == "rename") { 
+        *out << "No command found: " << commandName << std::endl;
+        return {};
+    } else if (match == "macro" && bonus) {
+        if (!createMacro(in)) {
+            return {{"EOF", 1}};
         }
-        if (isBuiltinCommand(match)) {
-            return to_string(multiplier) + match;
-        } else {
-            return match;
+        return {};
+    } else if (match == "macro") {
+        *out << "No command found: " << commandName << std::endl;
+        return {};
+    } else if (match == "help") {
+        *out << "Available commands:\n";
+        for (const auto& [key, _] : commands) {
+            *out << "- " << key << "\n";
         }
-    } else {
-        std::cout << "Invalid input format: \"" << first << "\". Type 'help' for a list of commands." << std::endl;
-        return "";
+        *out << "You can also prefix commands with a number (e.g., '3left' to move left three times).\n";
+    }
+    return commandsFor(match, multiplier);
+}
+
+ScriptOp CommandInterpreter::compileLine(const string& input, int line, string& error) const {
+    ScriptOp op{ScriptOp::Kind::Raw, line, input, {}, "", 0, false, "", "", false};
+
+    string action = input;
+    op.target = splitTarget(action);
+    op.specAct = matchSpecAct(action);
+
+    if (input == "-bonus") {
+        op.kind = ScriptOp::Kind::Resolved;
+        op.commands = {{"bonus", 1}};
+        return op;
+    }
+
+    istringstream iss{input};
+    string first, second;
+    iss >> first >> second;
+
+    int multiplier;
+    string commandName, match;
+    ostringstream message;
+
+    // a line that is not a command is also given to 'parseSpecAct' when the
+    // player picks a special action, so only lines that are neither are errors
+    if (!lookupCommand(first, multiplier, commandName, match, message) || match.empty()) {
+        if (op.specAct.empty()) error = to_string(line) + ": " + message.str();
+
+        op.kind = ScriptOp::Kind::Resolved;
+        op.message = message.str();
+        return op;
+    }
+
+    // these depend on (or change) the commands when they run, so they are
+    // parsed at that point
+    if (match == "rename" || match == "macro" || match == "help") {
+        op.changesCommands = match != "help";
+        return op;
+    }
+
+    op.kind = ScriptOp::Kind::Resolved;
+
+    if (match == "sequence" || match == "norandom") {
+        op.hasFilename = true;
+        op.filename = second;
     }
+
+    op.commands = commandsFor(match, multiplier);
+
+    return op;
+}
+
+Commands CommandInterpreter::runOp(const ScriptOp& op, string& filename, bool bonus, std::istream& in) {
+    if (op.kind == ScriptOp::Kind::Raw) return parseLine(op.text, filename, bonus, in);
+
+    *out << op.message;
+
+    if (op.hasFilename) filename = op.filename;
+
+    return op.commands;
+}
+
+string CommandInterpreter::matchSpecAct(const string& action) {
+    if (abbreviates(action, "blind")) return "blind";
+    if (abbreviates(action, "heavy")) return "heavy";
+
+    // force, then the Block after some whitespace
+    size_t end = action.find_first_of(WHITESPACE);
+    if (end == string::npos || !abbreviates(action.substr(0, end), "force")) return "";
+
+    size_t block = action.find_first_not_of(WHITESPACE, end);
+    if (block == string::npos || block + 1 != action.size()) return "";
+    if (string{"IJLOSZT"}.find(toupper(static_cast<unsigned char>(action[block]))) == string::npos) return "";
+
+    return action.substr(block);
+}
+
+int CommandInterpreter::splitTarget(string& input) {
+    // one to three digits, after whitespace which itself follows the action
+    size_t digits = input.size();
+    while (digits > 0 && isdigit(static_cast<unsigned char>(input[digits - 1]))) --digits;
+
+    size_t count = input.size() - digits;
+    if (count < 1 || count > 3 || digits == 0) return 0;
+
+    size_t end = input.find_last_not_of(WHITESPACE, digits - 1);
+    if (end == string::npos || end + 1 == digits) return 0;
+
+    int target = std::stoi(input.substr(digits));
+    input.erase(end + 1);
+
+    return target;
 }
 
-std::string CommandInterpreter::parseSpecAct(std::istream& in) const {
-    cout << "Choose a special action (blind, heavy, force <blockType>): ";
+std::string CommandInterpreter::parseSpecAct(std::istream& in, int& target) const {
+    *out << SPEC_ACT_PROMPT;
     string input;
+    target = 0;
 
-    if (!getline(in, input)) {
-        return "EOF";
-    }
-
-    // match the three special actions
-    std::regex blindPattern("^b(l(i(n(d)?)?)?)?$", std::regex::icase);
-    std::regex heavyPattern("^h(e(a(v(y)?)?)?)?$", std::regex::icase);
-    std::regex forcePattern("^(f(o(r(c(e)?)?)?)?)\\s+(I|J|L|O|S|Z|T)$", std::regex::icase);
-
-    if (regex_match(input, blindPattern)) {
-        return "blind";
-    } else if (regex_match(input, heavyPattern)) {
-        return "heavy";
-    } else if (regex_match(input, forcePattern)) {
-        // extract block type for force
-        std::smatch match;
-        if (regex_search(input, match, forcePattern)) {
-            //
-            if (match[6].matched) {
-                return match[6];
-            }
+    {
+        Trace::Span trace{"input", "input wait"};
+
+        if (!getline(in, input)) {
+            return "EOF";
         }
-        cout << "Invalid block type for 'force'.\n";
-        return "";
-    } else {
+    }
+
+    target = splitTarget(input);
+
+    string action = matchSpecAct(input);
+
+    if (action.empty()) {
         // invalid input
-        cout << "Invalid special action. No action will be applied.\n";
-        return "";
+        *out << "Invalid special action. No action will be applied.\n";
+    }
+    return action;
+}
+
+std::string CommandInterpreter::runSpecAct(const ScriptOp& op, int& target) const {
+    *out << SPEC_ACT_PROMPT;
+    target = op.target;
+
+    if (op.specAct.empty()) {
+        *out << "Invalid special action. No action will be applied.\n";
+    }
+    return op.specAct;
+}
+
+void CommandInterpreter::setOutput(std::ostream& o) { out = &o; }
+
+uint64_t CommandInterpreter::commandsHash() const {
+    // the map's order is not fixed, so the commands are sorted first
+    vector<pair<string, string>> sorted(commands.begin(), commands.end());
+    sort(sorted.begin(), sorted.end());
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (const auto& [key, value] : sorted) {
+        for (unsigned char c : key + '\0' + value + '\0') hash = (hash ^ c) * 0x100000001B3ULL;
     }
+
+    return hash;
 }
@@ -0,0 +1,75 @@
+#include "coroutine.h"
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+
+Coroutine::Coroutine(std::function<void()> body, size_t stackSize):
+    stack{nullptr}, stackSize{stackSize}, guardSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))},
+    body{std::move(body)}, running{false}, finished{false} {
+    stack = mmap(nullptr, guardSize + stackSize, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+
+    // the stack grows down, towards the guard page
+    if (stack != MAP_FAILED && mprotect(stack, guardSize, PROT_NONE) != 0) {
+        munmap(stack, guardSize + stackSize);
+        stack = MAP_FAILED;
+    }
+
+    if (stack == MAP_FAILED) {
+        stack = nullptr;
+        finished = true;
+        return;
+    }
+
+    getcontext(&context);
+    context.uc_stack.ss_sp = static_cast<char *>(stack) + guardSize;
+    context.uc_stack.ss_size = stackSize;
+    context.uc_link = &caller;
+
+    // makecontext only passes ints, so the pointer is split in two
+    uintptr_t self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&context, reinterpret_cast<void (*)()>(&Coroutine::entry), 2,
+                static_cast<unsigned int>(self), static_cast<unsigned int>(static_cast<uint64_t>(self) >> 32));
+}
+
+Coroutine::~Coroutine() {
+    // a body that never returned simply loses its stack: whatever it still
+    // owns on it is not destroyed
+    if (stack) munmap(stack, guardSize + stackSize);
+}
+
+void Coroutine::entry(unsigned int low, unsigned int high) {
+    Coroutine *self = reinterpret_cast<Coroutine *>(static_cast<uintptr_t>(static_cast<uint64_t>(high) << 32 | low));
+
+    // an exception must not leave the coroutine's stack
+    try {
+        self->body();
+    } catch (...) {
+        self->error = std::current_exception();
+    }
+
+    self->finished = true;
+    // returning goes back to 'caller' through uc_link
+}
+
+bool Coroutine::resume() {
+    if (finished) return false;
+
+    running = true;
+    swapcontext(&caller, &context);
+    running = false;
+
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+
+    return !finished;
+}
+
+void Coroutine::suspend() { swapcontext(&context, &caller); }
+
+bool Coroutine::isFinished() const { return finished; }
+
+bool Coroutine::isRunning() const { return running; }
@@ -0,0 +1,230 @@
+#include "eventStream.h"
+#include "game.h"
+#include "trace.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <fcntl.h>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+static const uint8_t MAGIC[] = {'B', 'Q', 'E', 'V', 1};
+// player, level, score, next Block, and the cells
+static const size_t KEY_SIZE = 1 + 1 + 4 + 1 + Frame::ROWS * Frame::COLS;
+static_assert(KEY_SIZE <= 255, "a Board must fit in one record");
+// (index, cell) pairs in one CELLS record, after the player
+static const size_t CELLS_PER_RECORD = 127;
+static_assert(Frame::ROWS * Frame::COLS <= 256, "a cell's index must fit in a byte");
+// how long a sink waits between two tries to open a FIFO nobody reads yet
+static const auto RETRY_OPEN = std::chrono::milliseconds{20};
+
+EventStream::EventStream(Game *game): game{game}, logFd{memfd_create("biquadris-events", MFD_CLOEXEC)} {
+    if (logFd == -1) return;
+
+    if (write(logFd, MAGIC, sizeof(MAGIC)) == sizeof(MAGIC)) size.store(sizeof(MAGIC));
+}
+
+EventStream::~EventStream() {
+    stopping.store(true, std::memory_order_release);
+    version.fetch_add(1, std::memory_order_release);
+    version.notify_all();
+
+    for (auto &sink : sinks) sink->thread.join();
+
+    if (logFd != -1) close(logFd);
+}
+
+bool EventStream::isOpen() const { return logFd != -1 && size.load() > 0; }
+
+void EventStream::addSink(const std::string &path) {
+    sinks.push_back(std::make_unique<Sink>());
+    Sink &sink = *sinks.back();
+    sink.path = path;
+    sink.thread = std::thread{&EventStream::follow, this, std::ref(sink)};
+}
+
+void EventStream::putU32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = value >> (8 * i);
+}
+
+void EventStream::record(Type type, const uint8_t *payload, size_t length) {
+    pending.push_back(type);
+    pending.push_back(length);
+    pending.insert(pending.end(), payload, payload + length);
+}
+
+void EventStream::record(Type type, std::initializer_list<uint8_t> payload) {
+    record(type, payload.begin(), payload.size());
+}
+
+void EventStream::encodeKey(int player) {
+    uint8_t key[KEY_SIZE];
+    uint8_t *cells = key + 7;
+    char next = ' ';
+
+    for (char c : curr.next[player]) if (c != ' ') next = c;
+
+    key[0] = player;
+    key[1] = curr.levels[player];
+    putU32(key + 2, curr.scores[player]);
+    key[6] = next;
+
+    for (int i = 0; i < Frame::ROWS; ++i) {
+        for (int j = 0; j < Frame::COLS; ++j) *cells++ = curr.cell(player, i, j);
+    }
+
+    record(KEY, key, sizeof(key));
+
+    uint8_t score[9] = {static_cast<uint8_t>(player)};
+    putU32(score + 1, curr.scores[player]);
+    putU32(score + 5, curr.hiScore);
+    record(SCORE, score, sizeof(score));
+}
+
+void EventStream::encodeChanges(int player) {
+    if (curr.levels[player] != prev.levels[player]) {
+        record(LEVEL, {static_cast<uint8_t>(player), static_cast<uint8_t>(curr.levels[player])});
+    }
+
+    if (curr.scores[player] != prev.scores[player] || curr.hiScore != prev.hiScore) {
+        uint8_t score[9] = {static_cast<uint8_t>(player)};
+        putU32(score + 1, curr.scores[player]);
+        putU32(score + 5, curr.hiScore);
+        record(SCORE, score, sizeof(score));
+    }
+
+    uint8_t changes[1 + 2 * CELLS_PER_RECORD] = {static_cast<uint8_t>(player)};
+    size_t changed = 0;
+
+    for (int i = 0; i < Frame::ROWS; ++i) {
+        for (int j = 0; j < Frame::COLS; ++j) {
+            char c = curr.cell(player, i, j);
+
+            if (c == prev.cell(player, i, j)) continue;
+
+            changes[1 + 2 * changed] = i * Frame::COLS + j;
+            changes[2 + 2 * changed] = c;
+
+            if (++changed == CELLS_PER_RECORD) {
+                record(CELLS, changes, 1 + 2 * changed);
+                changed = 0;
+            }
+        }
+    }
+
+    if (changed > 0) record(CELLS, changes, 1 + 2 * changed);
+}
+
+void EventStream::flush() {
+    uint8_t number[4];
+    putU32(number, frames++);
+    record(FRAME, number, sizeof(number));
+
+    // a single write, so a sink never sees part of a notification unless the
+    // memfd itself runs out of room
+    size_t written = 0;
+
+    while (written < pending.size()) {
+        ssize_t n = write(logFd, pending.data() + written, pending.size() - written);
+
+        if (n < 0 && errno == EINTR) continue;
+        else if (n <= 0) break;
+
+        written += n;
+    }
+
+    pending.clear();
+    size.fetch_add(written, std::memory_order_release);
+    version.fetch_add(1, std::memory_order_release);
+    version.notify_all();
+}
+
+void EventStream::notify() {
+    if (logFd == -1) return;
+
+    curr.capture(*game);
+
+    if (frames % KEY_INTERVAL == 0 || curr.numPlayers != prev.numPlayers) {
+        for (int p = 0; p < curr.numPlayers; ++p) encodeKey(p);
+
+        record(TURN, {static_cast<uint8_t>(curr.turn)});
+    } else {
+        for (int p = 0; p < curr.numPlayers; ++p) encodeChanges(p);
+
+        if (curr.turn != prev.turn) record(TURN, {static_cast<uint8_t>(curr.turn)});
+    }
+
+    flush();
+    std::swap(prev, curr);
+}
+
+void EventStream::notifyWin() {
+    if (logFd == -1) return;
+
+    record(WIN, {static_cast<uint8_t>(game->getPlayerTurn())});
+    flush();
+}
+
+void EventStream::notifySpawn(int player, char block, char next) {
+    record(SPAWN, {static_cast<uint8_t>(player), static_cast<uint8_t>(block), static_cast<uint8_t>(next)});
+}
+
+void EventStream::notifyClear(int player, int rows) {
+    record(CLEAR, {static_cast<uint8_t>(player), static_cast<uint8_t>(rows)});
+}
+
+void EventStream::notifySpecialAction(int player, int target, const std::string &action) {
+    std::vector<uint8_t> payload{static_cast<uint8_t>(player), static_cast<uint8_t>(target)};
+    payload.insert(payload.end(), action.begin(), action.end());
+    record(SPECIAL, payload.data(), payload.size());
+}
+
+void EventStream::follow(Sink &sink) {
+    // a reader closing its end gives EPIPE here instead of ending the game
+    sigset_t pipe;
+    sigemptyset(&pipe);
+    sigaddset(&pipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+    Trace::nameThread("broadcast");
+
+    // a FIFO cannot be opened before it has a reader, which may never come
+    int out;
+
+    while ((out = open(sink.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK | O_CLOEXEC, 0644)) == -1) {
+        if (errno == ENXIO && !stopping.load(std::memory_order_acquire)) std::this_thread::sleep_for(RETRY_OPEN);
+        else if (errno != EINTR) {
+            if (errno != ENXIO) std::cerr << "Cannot open " << sink.path << std::endl;
+            return;
+        }
+    }
+
+    fcntl(out, F_SETFL, fcntl(out, F_GETFL) & ~O_NONBLOCK);
+
+    off_t offset = 0;
+
+    while (true) {
+        uint64_t seen = version.load(std::memory_order_acquire);
+        // read before the size, so what was written before stopping is sent
+        bool last = stopping.load(std::memory_order_acquire);
+        off_t end = size.load(std::memory_order_acquire);
+
+        while (offset < end) {
+            ssize_t n = sendfile(out, logFd, &offset, end - offset);
+
+            if (n < 0 && errno == EINTR) continue;
+            else if (n <= 0) {
+                close(out);
+                return;
+            }
+        }
+
+        if (last) break;
+
+        version.wait(seen, std::memory_order_acquire);
+    }
+
+    close(out);
+}
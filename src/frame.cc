@@ -0,0 +1,36 @@
+#include "frame.h"
+#include "block.h"
+#include "game.h"
+
+void Frame::capture(Game &game) {
+    numPlayers = game.getNumPlayers();
+    turn = game.getPlayerTurn();
+    hiScore = game.getHiScore();
+    levels.resize(numPlayers);
+    scores.resize(numPlayers);
+    cells.resize(numPlayers);
+    next.resize(numPlayers);
+
+    for (int p = 0; p < numPlayers; ++p) {
+        levels[p] = game.getLevel(p);
+        scores[p] = game.getScore(p);
+
+        for (int i = 0; i < ROWS; ++i) {
+            for (int j = 0; j < COLS; ++j) cells[p][i * COLS + j] = game.getState(p, i, j);
+        }
+
+        Block *nextBlock = game.getNextBlock(p);
+
+        next[p].fill(' ');
+
+        for (auto &coord : nextBlock->getCoords()) {
+            int row = coord.second - NEXT_TOP;
+
+            if (row >= 0 && row < NEXT_ROWS && coord.first >= 0 && coord.first < NEXT_COLS) {
+                next[p][row * NEXT_COLS + coord.first] = nextBlock->getBlockSymbol();
+            }
+        }
+    }
+
+    taken = Clock::now();
+}
@@ -1,46 +1,56 @@
 #include "game.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <utility>
 
+#include "blockSequence.h"
 #include "board.h"
+#include "profile.h"
+#include "trace.h"
 
 Game::Game(bool bonus, int seed, string seq0, string seq1, int startLevel)
-    : bonus{bonus}, heavySpecAct{false}, hiScore{0}, currPlayerIdx{0}, consec_drop0{0}, consec_drop1{0} {
-    // setting up the players
-    p0 = std::make_unique<Player>(seq0, startLevel);
-    p1 = std::make_unique<Player>(seq1, startLevel);
-    currPlayerPointer = p0.get();
-    // setting up the board for each player, though they do not actually have
-    // access to their associated player
-    board0 = std::make_unique<Board>();
-    board1 = std::make_unique<Board>();
+    : Game{bonus, seed, std::vector<std::string>{seq0, seq1}, startLevel} {}
+
+Game::Game(bool bonus, int seed, const std::vector<std::string>& seqs, int startLevel)
+    : numPlayers{static_cast<int>(seqs.size())}, bonus{bonus}, heavySpecAct{false}, hiScore{0},
+      currPlayerIdx{0}, random{static_cast<unsigned>(seed)}, consecDrops(numPlayers, 0), isOut(numPlayers, false), playersLeft{numPlayers},
+      pendingSpecActs(numPlayers),
+      boards{std::make_unique<Board[]>(numPlayers)}, out{&std::cout}, sources(numPlayers),
+      sourceIdx(numPlayers, P0_IDX), replayFps{-1}, unshown{false}, fedBuf{*this}, fedIn{&fedBuf} {
+    // setting up the players, all at once so that they never move
+    players.reserve(numPlayers);
+
+    for (const auto& seq : seqs) players.emplace_back(seq, startLevel, random);
+
+    currPlayerPointer = &players[P0_IDX];
     // initializing the command interpreter
     ci = std::make_unique<CommandInterpreter>();
+    // all players read from std::cin until told otherwise
+    for (auto& source : sources) source.in = &std::cin;
 }
 
 // Get the state of one of the Boards
 char Game::getState(int playerIdx, int row, int col) const {
-    if (playerIdx == P0_IDX)
-        return board0->charAt(row, col);
-    else
-        return board1->charAt(row, col);
+    return boards[playerIdx].charAt(row, col);
 }
 
-Block* Game::getNextBlock(int player) {
-    return (player == P0_IDX) ? board0->nextBlock.get() : board1->nextBlock.get();
-}
+Block* Game::getNextBlock(int player) { return boards[player].nextBlock.get(); }
 
-int Game::getLevel(int player) const {
-    return (player == P0_IDX) ? p0->getLevel() : p1->getLevel();
-}
+int Game::getLevel(int player) const { return players[player].getLevel(); }
 
-int Game::getScore(int player) const {
-    return (player == P0_IDX) ? p0->getScore() : p1->getScore();
-}
+int Game::getScore(int player) const { return players[player].getScore(); }
 
 int Game::getHiScore() const { return hiScore; }
 
-void Game::updateHiScore() { hiScore = max(hiScore, max(p0->getScore(), p1->getScore())); }
+int Game::getNumPlayers() const { return numPlayers; }
+
+bool Game::isPlayerOut(int player) const { return isOut[player]; }
+
+void Game::updateHiScore() {
+    for (const auto& player : players) hiScore = max(hiScore, player.getScore());
+}
 
 int Game::getPlayerTurn() const {
     return currPlayerIdx;
@@ -57,21 +67,40 @@ bool Game::switchPlayerTurn() {
     // Board, and determining whether they have lost
     bool playerLost = updateBlock();
 
-    // updating the Player pointer
-    if (currPlayerIdx == P0_IDX)
-        currPlayerPointer = p1.get();
-    else
-        currPlayerPointer = p0.get();
-
-    // updating the player 'index'
-    currPlayerIdx = 1 - currPlayerIdx;
+    // updating the player 'index' and the Player pointer
+    currPlayerIdx = nextPlayer(currPlayerIdx);
+    currPlayerPointer = &players[currPlayerIdx];
 
     return playerLost;
 }
 
+int Game::nextPlayer(int idx) const {
+    do idx = (idx + 1) % numPlayers;
+    while (isOut[idx]);
+
+    return idx;
+}
+
+bool Game::eliminate(int player) {
+    isOut[player] = true;
+    --playersLeft;
+
+    if (playersLeft < 2) return false;
+
+    // special actions against the Player are lost with them
+    pendingSpecActs[player].clear();
+    *out << "Player " << player + 1 << " is out!" << std::endl;
+
+    return true;
+}
+
 bool Game::updateBlock() {
+    char block = getBoard()->getNextBlock()->getBlockSymbol();
+    char next = currPlayerPointer->getBlock();
+
     getBoard()->setNewCurrentBlock(getBoard()->getBoardNextBlock());
-    getBoard()->setNewNextBlock(createBlock(currPlayerPointer->getBlock()));
+    getBoard()->setNewNextBlock(createBlock(next));
+    notifySpawn(currPlayerIdx, block, next);
 
     bool success = getBoard()->tryPlaceBlock();
 
@@ -83,101 +112,121 @@ bool Game::updateBlock() {
     return !success;
 }
 
-std::shared_ptr<Block> Game::createBlock(const char block) {
+BlockRef Game::createBlock(const char block) {
     Player* p = currPlayerPointer;
 
     if (block == 'I')
-        return make_shared<IBlock>(p->getLevel(), p);
+        return blocks.make<IBlock>(p->getLevel(), p);
     else if (block == 'J')
-        return make_shared<JBlock>(p->getLevel(), p);
+        return blocks.make<JBlock>(p->getLevel(), p);
     else if (block == 'L')
-        return make_shared<LBlock>(p->getLevel(), p);
+        return blocks.make<LBlock>(p->getLevel(), p);
     else if (block == 'O')
-        return make_shared<OBlock>(p->getLevel(), p);
+        return blocks.make<OBlock>(p->getLevel(), p);
     else if (block == 'S')
-        return make_shared<SBlock>(p->getLevel(), p);
+        return blocks.make<SBlock>(p->getLevel(), p);
     else if (block == 'Z')
-        return make_shared<ZBlock>(p->getLevel(), p);
+        return blocks.make<ZBlock>(p->getLevel(), p);
     else
-        return make_shared<TBlock>(p->getLevel(), p);
+        return blocks.make<TBlock>(p->getLevel(), p);
 }
 
-Board* Game::getBoard() const {
-    return currPlayerIdx == P0_IDX ? board0.get() : board1.get();
-}
+Board* Game::getBoard() const { return &boards[currPlayerIdx]; }
 
 void Game::restart() {
     currPlayerIdx = P0_IDX;
-    currPlayerPointer = p0.get();
-    board0 = std::make_unique<Board>();
-    board1 = std::make_unique<Board>();
-    p0->restart();
-    p1->restart();
+    currPlayerPointer = &players[P0_IDX];
+
+    for (int p = 0; p < numPlayers; ++p) boards[p] = Board{};
+
+    for (auto& player : players) player.restart();
+
     clearSpecActs();
-    consec_drop0 = 0;
-    consec_drop1 = 0;
+    std::fill(consecDrops.begin(), consecDrops.end(), 0);
+    std::fill(isOut.begin(), isOut.end(), false);
+    playersLeft = numPlayers;
+
+    for (auto& specActs : pendingSpecActs) specActs.clear();
+
     gameInit();
 }
 
 // Tries to drop a 1-by-1 block in the middle column of the current player's board.
 // Returns True if successful, and False otherwise (the player loses, since the
 // middle column is full and cannot take an extra block)
-bool Game::addPenalty() {
-    if (currPlayerIdx == P0_IDX)
-        return board0->dropStarBlock(currPlayerPointer);
-    else
-        return board1->dropStarBlock(currPlayerPointer);
-}
+bool Game::addPenalty() { return getBoard()->dropStarBlock(blocks.make<StarBlock>(currPlayerPointer)); }
 
-// prompts the current player if they cleared more than 1 row this turn to pick
-// one or more special actions, depending on the number of rows cleared
-std::vector<std::string> Game::promptForSpecAct(int rowsCleared, bool& isEOF) {
+// prompts the player if they cleared more than 1 row this turn to pick one or
+// more special actions, depending on the number of rows cleared
+void Game::promptForSpecAct(int player, int rowsCleared, bool& isEOF) {
     int numOfSpecAct;
 
     if (bonus) numOfSpecAct = rowsCleared - SPECIAL_ACTION_THRES;
     else if (rowsCleared > 1) numOfSpecAct = 1;
     else numOfSpecAct = 0;
 
-    std::vector<std::string> validInputSpecAct;
+    int numPicked = 0;
 
     if (numOfSpecAct > 0) {
-        cout << "Multiple rows cleared!" << " You are allowed to pick " << numOfSpecAct;
+        Trace::Span trace{"game", "special action prompt"};
+
+        *out << "Multiple rows cleared!" << " You are allowed to pick " << numOfSpecAct;
 
         // different output depending on the number of special actions the player
         // can pick
         if (numOfSpecAct > 1)
-            cout << " special actions.\n";
+            *out << " special actions.\n";
         else
-            cout << " special action.\n";
+            *out << " special action.\n";
+
+        if (numPlayers > 2)
+            *out << "Follow a special action with a player's number to target them (the next player by default).\n";
 
-        while (validInputSpecAct.size() != numOfSpecAct) {
+        while (numPicked != numOfSpecAct) {
             std::string specActPicked;
+            int target;
 
-            if (readFromSeq.is_open()) {
-                specActPicked = ci->parseSpecAct(readFromSeq);
+            if (source(player).readFromSeq) {
+                const ScriptOp* op = source(player).readFromSeq->nextOp();
+                // past the last line, the player is still prompted before the
+                // end of the file is noticed
+                std::istringstream end;
+                specActPicked = op ? ci->runSpecAct(*op, target) : ci->parseSpecAct(end, target);
 
                 if (specActPicked == sEOF) {
-                    readFromSeq.close();
-                    std::cout << "Sequence file completed." << std::endl;
+                    showUnshown();
+                    source(player).readFromSeq.reset();
+                    *out << "Sequence file completed." << std::endl;
                     continue;
                 }
             } else {
-                specActPicked = ci->parseSpecAct(std::cin);
+                specActPicked = ci->parseSpecAct(*source(player).in, target);
 
                 if (specActPicked == sEOF) {
                     isEOF = true;
-                    return validInputSpecAct;
+                    return;
                 }
             }
 
-            if (specActPicked != "") checkDupSpecAct(validInputSpecAct, specActPicked);
+            if (specActPicked == "") continue;
+
+            // players are numbered from 1, and 0 means none was named
+            int victim = target == 0 ? nextPlayer(player) : target - 1;
+
+            if (victim < 0 || victim >= numPlayers || victim == player || isOut[victim]) {
+                *out << "Invalid player. No action will be applied.\n";
+                continue;
+            }
+
+            if (checkDupSpecAct(pendingSpecActs[victim], specActPicked)) {
+                notifySpecialAction(player, victim, specActPicked);
+                ++numPicked;
+            }
         }
     }
-
-    return validInputSpecAct;
 }
 
-void Game::checkDupSpecAct(std::vector<std::string>& specActs, std::string toAdd) {
+bool Game::checkDupSpecAct(std::vector<std::string>& specActs, std::string toAdd) {
     // looking for duplicates, only one loop is needed due to how we check for
     // duplicates when we try to add 'toAdd' onto 'specActs'
     for (auto specAct : specActs) {
@@ -188,17 +237,19 @@ void Game::checkDupSpecAct(std::vector<std::string>& specActs, std::string toAdd
         // force, so a duplicate is detected if there is already a string of
         // length 1 in 'specActs', as 'force' was already given previously.
         if (specAct == toAdd || (specAct.size() == 1 && toAdd.size() == 1)) {
-            std::cout << "Removed duplicate special actions.\n";
-            return;
+            *out << "Removed duplicate special actions.\n";
+            return false;
         }
     }
 
     // if we reach here, then 'toAdd' was not a duplicate special action, and we
     // can add it to the active special actions
     specActs.push_back(toAdd);
+    return true;
 }
 
 void Game::getPoints(int rowsCleared) {
+    if (rowsCleared > 0) notifyClear(currPlayerIdx, rowsCleared);
     currPlayerPointer->scoreRow(rowsCleared);
     updateHiScore();
 }
@@ -211,28 +262,26 @@ void Game::play() {
     bool isEOF = false;
     bool gameReset = false;
 
-    // setting up both Board for the first turn
+    // setting up every Board for the first turn
     gameInit();
 
-    // storing the active special actions for the next player
-    std::vector<std::string> activeSpecActs;
-
     // the 'while' loop condition plays the turn, while the loop content performs
     // most of the end of turn mechanics not done by 'playTurn()', such as
     // prompting for special actions
-    while (playTurn(currTurnRowsCleared, currPlayLose, activeSpecActs, gameReset)) {
+    while (playTurn(currTurnRowsCleared, currPlayLose, gameReset)) {
         if (gameReset) {
             gameReset = false;
-            activeSpecActs.clear();
             continue;
         }
 
+        int lastPlayerIdx = currPlayerIdx;
+
         bool playerEndTurn = currPlayerPointer->turnEnd(currTurnRowsCleared);
         bool addingPenaltyCauseLoss = false;
 
         if (playerEndTurn) {
             addingPenaltyCauseLoss = !addPenalty();
-            notifyObservers();
+            show();
 
             getPoints(getBoard()->clearFullRows());
         }
@@ -251,6 +300,14 @@ void Game::play() {
         if (currPlayLose ||
             (playerEndTurn && addingPenaltyCauseLoss) ||
             switchPlayerCauseLoss) {
+            // with more than two Players left, the others play on without them
+            if (eliminate(lastPlayerIdx)) {
+                currPlayLose = false;
+                currTurnRowsCleared = 0;
+                continue;
+            }
+
+            showUnshown();
             notifyWin();
             
             bool gameRestart = checkForGameReset();
@@ -271,10 +328,11 @@ void Game::play() {
         // have reached EOF when trying to obtain special action(s) from the
         // Player, and if so, we terminate the program instead of going to the
         // next turn
-        activeSpecActs = promptForSpecAct(currTurnRowsCleared, isEOF);
+        promptForSpecAct(lastPlayerIdx, currTurnRowsCleared, isEOF);
 
         if (isEOF) {
-            std::cout << "End of input detected. Exiting..." << std::endl;
+            showUnshown();
+            *out << "End of input detected. Exiting..." << std::endl;
             return;
         }
 
@@ -282,36 +340,68 @@ void Game::play() {
         currTurnRowsCleared = 0;
     }
 
-    std::cout << "End of input detected. Exiting..." << std::endl;
+    showUnshown();
+    *out << "End of input detected. Exiting..." << std::endl;
 }
 
 void Game::gameInit() {
-    board0->setNewCurrentBlock(createBlock(p0->getBlock()));
-    board0->placeBlock();
-    board0->setNewNextBlock(createBlock(p0->getBlock()));
-    currPlayerPointer = p1.get();
-    board1->setNewCurrentBlock(createBlock(p1->getBlock()));
-    board1->placeBlock();
-    board1->setNewNextBlock(createBlock(p1->getBlock()));
-    currPlayerPointer = p0.get();
-}
-
-std::string Game::getCommand(std::string& filename) {
-    if (readFromSeq.is_open())
-        return ci->parseCommand(readFromSeq, filename, bonus);
-    else {
-        std::cout << "Enter command: ";
-        return ci->parseCommand(std::cin, filename, bonus);
+    for (int p = 0; p < numPlayers; ++p) {
+        currPlayerPointer = &players[p];
+        char block = players[p].getBlock();
+        boards[p].setNewCurrentBlock(createBlock(block));
+        boards[p].placeBlock();
+        char next = players[p].getBlock();
+        boards[p].setNewNextBlock(createBlock(next));
+        notifySpawn(p, block, next);
+    }
+
+    currPlayerPointer = &players[P0_IDX];
+}
+
+Commands Game::getCommand(std::string& filename) {
+    if (source().readFromSeq) {
+        const ScriptOp* op = source().readFromSeq->nextOp();
+
+        return op ? ci->runOp(*op, filename, bonus, *source().in) : Commands{{sEOF, 1}};
+    } else {
+        *out << "Enter command: ";
+
+        if (waitForCommand()) return {{sGravity, 1}};
+
+        return ci->parseCommand(*source().in, filename, bonus);
     }
 }
 
+bool Game::isOnly(const Commands& commands, const std::string& name) {
+    return commands.size() == 1 && commands[0].name == name;
+}
+
+bool Game::waitForCommand() {
+    if (source().in != &fedIn || !turns || !turns->isRunning()) return false;
+
+    // a tick is only noticed between lines, never in the middle of one
+    while (!fedBuf.hasLine()) {
+        if (fedBuf.takeTick()) return true;
+
+        turns->suspend();
+    }
+
+    return fedBuf.takeTick();
+}
+
 // Most of the mechanics for a player's turn. Some of the things done by this
 // method:
 // - Applying any Heavy properties, whether it be from Level or a special action
 // - Updating the number of rows cleared by the Player this turn.
 // This method runs essentially until EOF or the Player executes a 'drop' command,
 // or one of the 'heavy' properties force the player's block to be dropped.
-bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::string> specActs, bool& gameReset) {
+bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, bool& gameReset) {
+    Profile::count(Profile::Turns);
+    Trace::Span trace{"game", "turn"};
+
+    std::vector<std::string> specActs = std::move(pendingSpecActs[currPlayerIdx]);
+    pendingSpecActs[currPlayerIdx].clear();
+
     // applying the active special actions, and in the case that 'force' causes
     // the Player to lose, we immediately end the turn, but return true as the
     // player(s) can decide whether to restart
@@ -320,7 +410,7 @@ bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::str
         return true;
     }
     // prompt observers to display the Boards
-    notifyObservers();
+    show(true);
 
     // in the case the player decided to drop consecutive blocks by using a
     // multiplier for the 'drop' command, no input is read/needed and their
@@ -330,52 +420,56 @@ bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::str
     if (handleConsecDrops()) {
         rowsCleared = getBoard()->clearFullRows();
         getPoints(rowsCleared);
-        notifyObservers();
+        show();
 
         return true;
     }
 
     std::string filename;
 
-    std::string commandSeq = getCommand(filename);
+    Commands commands = getCommand(filename);
 
     while (true) {
-        if (commandSeq == "bonus") {
+        if (isOnly(commands, "bonus")) {
             if (bonus) {
-                std::cout << "Enhancements disabled." << std::endl;
+                *out << "Enhancements disabled." << std::endl;
                 bonus = false;
             } else {
-                std::cout << "Enhancements enabled." << std::endl;
+                *out << "Enhancements enabled." << std::endl;
                 bonus = true;
             }
 
-            commandSeq = getCommand(filename);
+            commands = getCommand(filename);
             continue;
-        } else if (commandSeq == sEOF && readFromSeq.is_open()) {
-            readFromSeq.close();
-            std::cout << "Sequence file completed." << std::endl;
-            commandSeq = getCommand(filename);
+        } else if (isOnly(commands, sEOF) && source().readFromSeq) {
+            showUnshown();
+            source().readFromSeq.reset();
+            *out << "Sequence file completed." << std::endl;
+            commands = getCommand(filename);
             continue;
-        } else if (commandSeq == sEOF) break;
-        else if (commandSeq == "") {
-            commandSeq = getCommand(filename);
-            continue;
-        }
-
-        std::istringstream iss{commandSeq};
-        std::string curr;
+        } else if (isOnly(commands, sEOF)) break;
+        else if (isOnly(commands, sGravity)) {
+            // the Block lands where it is when it cannot fall any further
+            if (!applyHeavy()) {
+                getBoard()->setNewCurrentBlock(nullptr);
 
-        while (iss >> curr) {
-            size_t multIdx = 0;
-            int multiplier = 1;
+                rowsCleared = getBoard()->clearFullRows();
+                getPoints(rowsCleared);
 
-            // getting all the digits of the multiplier
-            while (multIdx < curr.size() && std::isdigit(curr[multIdx])) ++multIdx;
+                if (rowsCleared > 1) show();
 
-            if (multIdx > 0) multiplier = std::stoi(curr.substr(0, multIdx));
+                return true;
+            }
 
-            std::string command = curr.substr(multIdx);
+            show();
+            commands = getCommand(filename);
+            continue;
+        } else if (commands.empty()) {
+            commands = getCommand(filename);
+            continue;
+        }
 
+        for (const auto& [command, multiplier] : commands) {
             if (command == "drop" && multiplier > 0) {
                 setConsecDrops(multiplier - 1);
                 getBoard()->dropBlock();
@@ -384,7 +478,7 @@ bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::str
                 rowsCleared = getBoard()->clearFullRows();
                 getPoints(rowsCleared);
 
-                if (rowsCleared > 1) notifyObservers();
+                if (rowsCleared > 1) show();
 
                 return true;
             } else if (command == "help" || command == "rename") continue;
@@ -392,12 +486,17 @@ bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::str
                 restart();
                 gameReset = true;
                 return true;
-            } else if (command == "norandom")
-                currPlayerPointer->setNoRand(filename);
-            else if (command == "random")
+            } else if (command == "norandom") {
+                // a file with anything but Blocks in it is refused, the Level
+                // staying as it was
+                std::shared_ptr<const BlockSequence> seq = BlockSequence::load(filename);
+
+                if (seq->isValid()) currPlayerPointer->setNoRand(filename);
+                else *out << seq->getError() << std::endl;
+            } else if (command == "random")
                 currPlayerPointer->setRand();
             else if (command == "sequence")
-                readFromSeq.open(filename);
+                openSequence(filename);
             else if (command == "levelup")
                 levelUp(currPlayerIdx, multiplier);
             else if (command == "leveldown")
@@ -416,60 +515,211 @@ bool Game::playTurn(int& rowsCleared, bool& currPlayerLose, std::vector<std::str
                 return true;
         }
 
-            notifyObservers();
+            show();
         }
 
-        commandSeq = getCommand(filename);
+        commands = getCommand(filename);
     }
 
     return false;
 }
 
-void Game::levelUp(int idx, int multiplier) {
-    if (idx == 0) {
-        int lvl = p0->getLevel();
+void Game::setOutput(std::ostream& o) {
+    out = &o;
+    ci->setOutput(o);
+}
 
-        for (int i = 0; i < multiplier; ++i) p0->setLevel(++lvl);
-    } else {
-        int lvl = p1->getLevel();
+Game::FedInput::FedInput(Game& game) : game{game}, ended{false}, ticked{false}, lineLength{0} {}
+
+Game::FedInput::int_type Game::FedInput::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock{m};
+
+            if (!pending.empty()) {
+                current.swap(pending);
+                pending.clear();
+                setg(current.data(), current.data(), current.data() + current.size());
 
-        for (int i = 0; i < multiplier; ++i) p1->setLevel(++lvl);
+                return traits_type::to_int_type(*gptr());
+            } else if (ended) return traits_type::eof();
+        }
+
+        // outside of 'step' there is no way to wait for more
+        if (!game.turns || !game.turns->isRunning()) return traits_type::eof();
+
+        // back to whoever called 'step', which resumes from here
+        game.turns->suspend();
     }
 }
 
-void Game::levelDown(int idx, int multiplier) {
-    if (idx == 0) {
-        int lvl = p0->getLevel();
+void Game::FedInput::append(const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock{m};
 
-        for (int i = 0; i < multiplier; ++i) p0->setLevel(--lvl);
-    } else {
-        int lvl = p1->getLevel();
+    while (size > 0) {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', size));
+        size_t length = newline ? newline - data : size;
+
+        pending.append(data, std::min(length, MAX_LINE - std::min(lineLength, MAX_LINE)));
 
-        for (int i = 0; i < multiplier; ++i) p1->setLevel(--lvl);
+        if (!newline) {
+            lineLength += length;
+            return;
+        }
+
+        pending += '\n';
+        lineLength = 0;
+        size -= length + 1;
+        data = newline + 1;
+    }
+}
+
+void Game::FedInput::end() {
+    std::lock_guard<std::mutex> lock{m};
+    ended = true;
+}
+
+bool Game::FedInput::hasInput() const {
+    std::lock_guard<std::mutex> lock{m};
+    return !pending.empty() || ended || ticked;
+}
+
+void Game::FedInput::tick() {
+    std::lock_guard<std::mutex> lock{m};
+    ticked = true;
+}
+
+bool Game::FedInput::takeTick() {
+    std::lock_guard<std::mutex> lock{m};
+    return std::exchange(ticked, false);
+}
+
+bool Game::FedInput::hasLine() const {
+    // what is left of the chunk being read, which only the Game touches
+    if (std::find(gptr(), egptr(), '\n') != egptr()) return true;
+
+    std::lock_guard<std::mutex> lock{m};
+    return ended || pending.find('\n') != std::string::npos;
+}
+
+void Game::feed(const std::string& command) {
+    fedBuf.append(command.data(), command.size());
+    fedBuf.append("\n", 1);
+}
+
+void Game::feedInput(const char* data, size_t size) { fedBuf.append(data, size); }
+
+void Game::endInput() { fedBuf.end(); }
+
+void Game::tick() { fedBuf.tick(); }
+
+bool Game::hasInput() const { return fedBuf.hasInput(); }
+
+Game::Status Game::step() {
+    if (!turns) {
+        for (int p = 0; p < numPlayers; ++p) setInput(p, fedIn);
+
+        turns = std::make_unique<Coroutine>([this] { play(); });
+    }
+
+    return turns->resume() ? Status::NeedsInput : Status::Finished;
+}
+
+Game::Source& Game::source() { return source(currPlayerIdx); }
+
+Game::Source& Game::source(int player) { return sources[sourceIdx[player]]; }
+
+void Game::setInput(int player, std::istream& in) {
+    sources[player].in = &in;
+
+    // Players share the Source of the first Player reading the same input
+    for (int p = 0; p < numPlayers; ++p) {
+        sourceIdx[p] = p;
+
+        for (int q = 0; q < p; ++q) {
+            if (sources[q].in == sources[p].in) {
+                sourceIdx[p] = q;
+                break;
+            }
+        }
     }
 }
 
+void Game::setFileInput(int player) { source(player).isFile = true; }
+
+void Game::setReplayRendering(int framesPerSecond) { replayFps = framesPerSecond; }
+
+bool Game::replaying() { return source().readFromSeq || source().isFile; }
+
+void Game::show(bool turnStart) {
+    if (replayFps >= 0 && replaying()) {
+        auto now = std::chrono::steady_clock::now();
+        bool due = replayFps == 0 ? turnStart : now - lastShown >= std::chrono::nanoseconds{std::chrono::seconds{1}} / replayFps;
+
+        if (!due) {
+            unshown = true;
+            return;
+        }
+
+        lastShown = now;
+    }
+
+    unshown = false;
+    notifyObservers();
+}
+
+void Game::showUnshown() {
+    if (!unshown) return;
+
+    unshown = false;
+    notifyObservers();
+}
+
+void Game::openSequence(const std::string& filename) {
+    // a sequence file given while another one is being read ends the current
+    // one, same as opening an already open file stream would make it fail
+    if (source().readFromSeq) {
+        source().readFromSeq->abort();
+        return;
+    }
+
+    auto script = std::make_unique<Script>(filename, *ci);
+
+    if (!script->isOpen()) return;
+
+    for (const auto& error : script->getErrors()) *out << error;
+
+    source().readFromSeq = std::move(script);
+}
+
+void Game::levelUp(int idx, int multiplier) {
+    int lvl = players[idx].getLevel();
+
+    for (int i = 0; i < multiplier; ++i) players[idx].setLevel(++lvl);
+}
+
+void Game::levelDown(int idx, int multiplier) {
+    int lvl = players[idx].getLevel();
+
+    for (int i = 0; i < multiplier; ++i) players[idx].setLevel(--lvl);
+}
+
 bool Game::handleConsecDrops() {
     // return true in case where the current Player does automatically drop their
     // current Block, and their turn ends
-    if (currPlayerIdx == P0_IDX && consec_drop0 != 0) {
-        getBoard()->dropBlock();
-        getBoard()->setNewCurrentBlock(nullptr);
-        --consec_drop0;
-        return true;
-    } else if (currPlayerIdx == P1_IDX && consec_drop1 != 0) {
+    if (consecDrops[currPlayerIdx] != 0) {
         getBoard()->dropBlock();
         getBoard()->setNewCurrentBlock(nullptr);
-        --consec_drop1;
+        --consecDrops[currPlayerIdx];
         return true;
     }
 
     return false;
 }
 
-void Game::setConsecDrops(int multiplier) {
-    currPlayerIdx == P0_IDX ? consec_drop0 = multiplier : consec_drop1 = multiplier;
-}
+void Game::setConsecDrops(int multiplier) { consecDrops[currPlayerIdx] = multiplier; }
 
 bool Game::updateBoard(std::string command, int multiplier, bool& currPlayerLose) {
     // the only command that has a length of 1 is when we wish to set the currently
@@ -477,12 +727,13 @@ bool Game::updateBoard(std::string command, int multiplier, bool& currPlayerLose
     if (command.size() == 1) {
         getBoard()->removeBlock(true);
         getBoard()->setNewCurrentBlock(createBlock(command[0]));
+        notifySpawn(currPlayerIdx, command[0], getBoard()->getNextBlock()->getBlockSymbol());
 
         // try to place the new selected Block
         if (!getBoard()->tryPlaceBlock()) {
             // before returning, we output the updated Board, which is essentially
             // the Board after removing the old replaced Block
-            notifyObservers();
+            show();
             // the Player's turn has ended due to them losing
             currPlayerLose = true;
             // indicate turn end by returning true
@@ -500,6 +751,7 @@ bool Game::updateBoard(std::string command, int multiplier, bool& currPlayerLose
 }
 
 bool Game::executeMove(std::string command, int multiplier) {
+    Trace::Span trace{"game", "move"};
     int heavyMoves = getLevel(currPlayerIdx) >= HEAVY_LVL ? HEAVY_LVL_DOWN : 0;
 
     if (command == "left") {
@@ -542,6 +794,7 @@ bool Game::addSpecActs(std::vector<std::string> specActs) {
             getBoard()->removeBlock(true);
             // setting the current Block to the specified one
             getBoard()->setNewCurrentBlock(createBlock(specAct[0]));
+            notifySpawn(currPlayerIdx, specAct[0], getBoard()->getNextBlock()->getBlockSymbol());
 
             // try to place new specified Block, if we are unsuccessful, it means
             // the Player has lost
@@ -568,6 +821,7 @@ bool Game::isMovingCom(const std::string command) const {
 }
 
 bool Game::applyHeavy() {
+    Trace::Span trace{"game", "heavy"};
     // if it is not possible to move the Block, there is no need to call
     // the actual moving method, and we return false to signal that the
     // Block is dropped
@@ -580,49 +834,35 @@ bool Game::applyHeavy() {
     }
 }
 
-bool Game::isBoardBlind(int board) {
-    if (board == P0_IDX)
-        return board0->isBlind();
-    else
-        return board1->isBlind();
-}
+const BlockPool& Game::getBlockPool() const { return blocks; }
+
+bool Game::isBoardBlind(int board) { return boards[board].isBlind(); }
 
 bool Game::checkForGameReset() {
     // prompt text and graphical (if applicable) observers to display a Game Won
     // message, the only acceptable inputs are Y and N
 
-    std::string s, f;
+    Commands s;
+    std::string f;
 
-    if (readFromSeq.is_open()) {
+    if (source().readFromSeq) {
         s = getCommand(f);
 
-        while (s != sEOF) {
-            size_t multIdx = 0;
-
-            while (multIdx < s.size() && std::isdigit(s[multIdx])) ++multIdx;
-
-            std::string command = s.substr(multIdx);
-
-            if (command == "restart") return true;
+        while (!isOnly(s, sEOF)) {
+            if (isOnly(s, "restart")) return true;
 
             s = getCommand(f);
         }
 
-        std::cout << "Sequence file completed." << std::endl;
+        *out << "Sequence file completed." << std::endl;
     }
 
-    readFromSeq.close();
+    source().readFromSeq.reset();
 
     s = getCommand(f);
 
-    while (s != sEOF) {
-        size_t multIdx = 0;
-
-        while (multIdx < s.size() && std::isdigit(s[multIdx])) ++multIdx;
-
-        std::string command = s.substr(multIdx);
-
-        if (command == "restart") return true;
+    while (!isOnly(s, sEOF)) {
+        if (isOnly(s, "restart")) return true;
 
         s = getCommand(f);
     }
@@ -649,6 +889,7 @@ void Subject::detach(Observer* o) {
 void Subject::notifyObservers() {
     // Notify each observer in the vector
     for (auto it : observers) {
+        Trace::Span trace{"notify", it->name()};
         it->notify();
     }
 }
@@ -656,6 +897,25 @@ void Subject::notifyObservers() {
 void Subject::notifyWin() {
     // Notify each observer in the vector
     for (auto it : observers) {
+        Trace::Span trace{"notify", it->name()};
         it->notifyWin();
     }
 }
+
+void Subject::notifySpawn(int player, char block, char next) {
+    for (auto it : observers) {
+        it->notifySpawn(player, block, next);
+    }
+}
+
+void Subject::notifyClear(int player, int rows) {
+    for (auto it : observers) {
+        it->notifyClear(player, rows);
+    }
+}
+
+void Subject::notifySpecialAction(int player, int target, const std::string& action) {
+    for (auto it : observers) {
+        it->notifySpecialAction(player, target, action);
+    }
+}
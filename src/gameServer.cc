@@ -0,0 +1,341 @@
+#include "gameServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const size_t READ_SIZE = 64 * 1024;
+
+static bool socketAddress(const std::string &path, sockaddr_un &addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+
+    std::strcpy(addr.sun_path, path.c_str());
+
+    return true;
+}
+
+GameServer::GameServer(const std::string &path, int numWorkers, bool bonus, int seed,
+                       const std::vector<std::string> &seqs, int startLevel):
+    path{path}, bonus{bonus}, nextSeed{seed}, seqs{seqs}, startLevel{startLevel},
+    listenFd{-1}, epollFd{-1}, wakeFd{-1}, nextWorker{0}, stopping{false} {
+    for (int i = 0; i < std::max(numWorkers, 1); ++i) workers.push_back(std::make_unique<Worker>());
+}
+
+GameServer::~GameServer() {
+    for (auto &worker : workers) {
+        {
+            std::lock_guard<std::mutex> lock{worker->m};
+            stopping = true;
+        }
+
+        worker->cv.notify_one();
+
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    for (auto &[fd, client] : clients) ::close(fd);
+
+    if (listenFd != -1) {
+        ::close(listenFd);
+        unlink(path.c_str());
+    }
+
+    if (epollFd != -1) ::close(epollFd);
+    if (wakeFd != -1) ::close(wakeFd);
+}
+
+bool GameServer::run() {
+    sockaddr_un addr;
+
+    if (!socketAddress(path, addr)) return false;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    // a socket left behind by an earlier server would make 'bind' fail
+    unlink(path.c_str());
+
+    if (listenFd == -1 || bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epollFd == -1 || wakeFd == -1) return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    for (auto &worker : workers) {
+        Worker &w = *worker;
+        w.thread = std::thread{[this, &w] { work(w); }};
+    }
+
+    std::cout << "Serving on " << path << " with " << workers.size() << " workers" << std::endl;
+
+    epoll_event events[256];
+
+    while (true) {
+        int n = epoll_wait(epollFd, events, 256, -1);
+
+        if (n < 0 && errno == EINTR) continue;
+        else if (n < 0) return false;
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == listenFd) accept();
+            else if (fd == wakeFd) {
+                uint64_t count;
+                std::vector<Client *> toFlush;
+
+                while (read(wakeFd, &count, sizeof(count)) > 0) {}
+
+                {
+                    std::lock_guard<std::mutex> lock{outMutex};
+                    toFlush.swap(ready);
+
+                    for (Client *client : toFlush) client->queued = false;
+                }
+
+                for (Client *client : toFlush) flush(client);
+            } else {
+                auto it = clients.find(fd);
+
+                // closed earlier in this same batch of events
+                if (it == clients.end()) continue;
+
+                Client *client = it->second.get();
+
+                if (events[i].events & EPOLLOUT) flush(client);
+
+                if (clients.count(fd) && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) readFrom(client);
+            }
+        }
+    }
+}
+
+void GameServer::accept() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd == -1) return;
+
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        client->worker = nextWorker;
+        client->session = std::make_unique<GameSession>(bonus, nextSeed++, seqs, startLevel);
+        client->closing = false;
+        client->reading = true;
+        client->queued = false;
+        nextWorker = (nextWorker + 1) % workers.size();
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+        Client *c = client.get();
+        clients[fd] = std::move(client);
+
+        // the Game shows the Boards and asks for a command right away
+        if (c->session->feed("", 0)) schedule(c);
+    }
+}
+
+void GameServer::readFrom(Client *client) {
+    char buf[READ_SIZE];
+
+    while (client->reading) {
+        ssize_t n = read(client->fd, buf, sizeof(buf));
+
+        if (n > 0) {
+            if (client->session->feed(buf, n)) schedule(client);
+        } else if (n < 0 && errno == EINTR) continue;
+        else if (n < 0 && errno == EAGAIN) return;
+        else {
+            // the client closed its side (or is gone): the Game sees the end of
+            // its input, and the connection closes once the Game is over
+            client->reading = false;
+
+            epoll_event ev{};
+            ev.events = 0;
+            ev.data.fd = client->fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &ev);
+
+            if (client->session->endInput()) schedule(client);
+        }
+    }
+}
+
+void GameServer::flush(Client *client) {
+    bool done, waiting;
+
+    {
+        std::lock_guard<std::mutex> lock{outMutex};
+
+        while (!client->outbox.empty()) {
+            ssize_t n = send(client->fd, client->outbox.data(), client->outbox.size(), MSG_NOSIGNAL);
+
+            if (n > 0) client->outbox.erase(0, n);
+            else if (n < 0 && errno == EINTR) continue;
+            else if (n < 0 && errno == EAGAIN) break;
+            // the client is gone, what it was sent no longer matters
+            else client->outbox.clear();
+        }
+
+        done = client->closing && client->outbox.empty();
+        waiting = !client->outbox.empty();
+    }
+
+    if (done) {
+        close(client);
+        return;
+    }
+
+    // waits for room in the socket only while there is something to send
+    epoll_event ev{};
+    ev.events = (client->reading ? EPOLLIN | EPOLLRDHUP : 0) | (waiting ? EPOLLOUT : 0);
+    ev.data.fd = client->fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &ev);
+}
+
+void GameServer::close(Client *client) {
+    int fd = client->fd;
+
+    // a worker may have queued it again since it was last flushed, and the
+    // event loop must not find it in 'ready' once it is freed
+    {
+        std::lock_guard<std::mutex> lock{outMutex};
+
+        if (client->queued) ready.erase(std::find(ready.begin(), ready.end(), client));
+    }
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients.erase(fd);
+}
+
+void GameServer::schedule(Client *client) {
+    Worker &worker = *workers[client->worker];
+
+    {
+        std::lock_guard<std::mutex> lock{worker.m};
+        worker.queue.push_back(client);
+    }
+
+    worker.cv.notify_one();
+}
+
+void GameServer::work(Worker &worker) {
+    while (true) {
+        Client *client;
+
+        {
+            std::unique_lock<std::mutex> lock{worker.m};
+            worker.cv.wait(lock, [&] { return stopping || !worker.queue.empty(); });
+
+            if (stopping) return;
+
+            client = worker.queue.front();
+            worker.queue.pop_front();
+        }
+
+        std::string printed;
+
+        try {
+            printed = client->session->run();
+        } catch (const std::exception &e) {
+            printed = std::string{"Error: "} + e.what() + "\n";
+        }
+
+        bool finished = client->session->isFinished();
+
+        {
+            std::lock_guard<std::mutex> lock{outMutex};
+            client->outbox += printed;
+            // once 'closing' is set the event loop may free the Client at any
+            // point, so it is never touched again here. A finished session is
+            // also never scheduled again, as it stays marked as scheduled.
+            client->closing = finished;
+
+            if (!client->queued) {
+                client->queued = true;
+                ready.push_back(client);
+            }
+        }
+
+        uint64_t one = 1;
+        write(wakeFd, &one, sizeof(one));
+
+        if (!finished && client->session->runAgain()) schedule(client);
+    }
+}
+
+bool GameServer::client(const std::string &path) {
+    sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd == -1 || !socketAddress(path, addr) ||
+        connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        if (fd != -1) ::close(fd);
+        return false;
+    }
+
+    char buf[READ_SIZE];
+    bool stdinOpen = true;
+
+    while (true) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+
+        if (poll(fds, stdinOpen ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[0].revents) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+
+            // the server closes the connection when the Game is over
+            if (n <= 0) break;
+
+            std::cout.write(buf, n);
+            std::cout.flush();
+        }
+
+        if (stdinOpen && fds[1].revents) {
+            ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+
+            if (n <= 0) {
+                // lets the Game see the end of its input
+                stdinOpen = false;
+                shutdown(fd, SHUT_WR);
+            } else {
+                for (ssize_t sent = 0; sent < n;) {
+                    ssize_t m = send(fd, buf + sent, n - sent, MSG_NOSIGNAL);
+
+                    if (m <= 0) break;
+
+                    sent += m;
+                }
+            }
+        }
+    }
+
+    ::close(fd);
+
+    return true;
+}
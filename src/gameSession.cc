@@ -0,0 +1,60 @@
+#include "gameSession.h"
+
+GameSession::GameSession(bool bonus, int seed, const std::vector<std::string> &seqs, int startLevel):
+    scheduled{false}, finished{false}, out{&outBuf},
+    game{std::make_unique<Game>(bonus, seed, seqs, startLevel)},
+    textObs{std::make_unique<TextObserver>(game.get(), out)} {
+    game->attach(textObs.get());
+    game->setOutput(out);
+}
+
+bool GameSession::wake() {
+    std::lock_guard<std::mutex> lock{m};
+
+    if (scheduled) return false;
+
+    scheduled = true;
+
+    return true;
+}
+
+bool GameSession::feed(const char *data, size_t size) {
+    game->feedInput(data, size);
+
+    return wake();
+}
+
+bool GameSession::endInput() {
+    game->endInput();
+
+    return wake();
+}
+
+std::string GameSession::run() {
+    // a Game that threw is over as well
+    try {
+        finished = game->step() == Game::Status::Finished;
+    } catch (...) {
+        finished = true;
+        throw;
+    }
+
+    std::string printed = outBuf.str();
+    outBuf.str("");
+
+    return printed;
+}
+
+bool GameSession::runAgain() {
+    std::lock_guard<std::mutex> lock{m};
+
+    // the Game stopped because it had nothing to read, so anything it has not
+    // seen yet came while it was running
+    if (!finished && game->hasInput()) return true;
+
+    scheduled = false;
+
+    return false;
+}
+
+bool GameSession::isFinished() const { return finished; }
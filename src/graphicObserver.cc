@@ -1,4 +1,5 @@
 #include "graphicObserver.h"
+#include "profile.h"
 #include "window.h"
 #include <iostream>
 #include <string>
@@ -21,182 +22,138 @@ blindedness: black(?)
 // Implementation file for GraphicObserver
 
 GraphicObserver::GraphicObserver(Game *game):game{game} {
-    window = std::make_unique<Xwindow>(10*WINDOW_WIDTH, 10*WINDOW_HEIGHT);
-    charGrid1.resize(ROWS, std::vector<char>(COLS));
-    charGrid2.resize(ROWS, std::vector<char>(COLS));
-    nextGrid1.resize(NEXTROWS, std::vector<char>(NEXTCOLS));
-    nextGrid2.resize(NEXTROWS, std::vector<char>(NEXTCOLS));
+    numPlayers = game->getNumPlayers();
+    windowWidth = PLAYER_WIDTH * numPlayers - 2;
+    window = std::make_unique<Xwindow>(10*windowWidth, 10*WINDOW_HEIGHT);
     // Set all to blank initially
-    for (int i = 0; i < ROWS; ++i) {
-        for (int j = 0; j < COLS; ++j) {
-            charGrid1[i][j] = ' ';
-            charGrid2[i][j] = ' '; // Set both grids initially to blank
-        }
-    }
-    // Set all to blank initially
-    for (int i = 0; i < NEXTROWS; ++i) {
-        for (int j = 0; j < NEXTCOLS; ++j) {
-            nextGrid1[i][j] = ' ';
-            nextGrid2[i][j] = ' '; // Set both grids initially to blank
-        }
-    }
+    charGrids.resize(numPlayers, std::vector<std::vector<char>>(ROWS, std::vector<char>(COLS, ' ')));
+    nextGrids.resize(numPlayers, std::vector<std::vector<char>>(NEXTROWS, std::vector<char>(NEXTCOLS, ' ')));
+    prevLevels.resize(numPlayers, 0);
+    prevScores.resize(numPlayers, 0);
     // Header
-    window->drawString(115, 11, "BIQUADRIS");
+    window->drawString(5 * windowWidth - 25, 11, "BIQUADRIS");
     window->drawString(1, 25, "HISCORE: 0");
-    window->drawString(195, 25, "TURN: PLAYER 1");
-    // Level and score
-    window->drawString(9, 43, "LEVEL: 0");
-    window->drawString(159, 43, "LEVEL: 0");
-    window->drawString(9, 55, "SCORE: 0");
-    window->drawString(159, 55, "SCORE: 0");
-
-    // Left grid (l,r,t,b)
-    window->fillRectangle(9, 59, 1, 181, Xwindow::Black);
-    window->fillRectangle(120, 59, 1, 181, Xwindow::Black);
-    window->fillRectangle(9, 59, 112, 1, Xwindow::Black);
-    window->fillRectangle(9, 240, 112, 1, Xwindow::Black);
-
-    // Right grid
-    window->fillRectangle(159, 59, 1, 181, Xwindow::Black);
-    window->fillRectangle(270, 59, 1, 181, Xwindow::Black);
-    window->fillRectangle(159, 59, 112, 1, Xwindow::Black);
-    window->fillRectangle(159, 240, 112, 1, Xwindow::Black);
-
-    // Next
-    window->drawString(10, 260, "NEXT:");
-    window->drawString(159, 260, "NEXT:");
+    window->drawString(10 * windowWidth - 85, 25, "TURN: PLAYER 1");
+
+    for (int p = 0; p < numPlayers; ++p) {
+        int left = playerLeft(p);
+        // Level and score
+        window->drawString(left, 43, "LEVEL: 0");
+        window->drawString(left, 55, "SCORE: 0");
+
+        // Grid (l,r,t,b)
+        window->fillRectangle(left, 59, 1, 181, Xwindow::Black);
+        window->fillRectangle(left + 111, 59, 1, 181, Xwindow::Black);
+        window->fillRectangle(left, 59, 112, 1, Xwindow::Black);
+        window->fillRectangle(left, 240, 112, 1, Xwindow::Black);
+
+        // Next
+        window->drawString(left, 260, "NEXT:");
+    }
 }
 
+const Xwindow &GraphicObserver::getWindow() const { return *window; }
+
 // Notify
 void GraphicObserver::notify() {
-    print();
+    frame.capture(*game);
+    render(frame);
 }
 
 void GraphicObserver::notifyWin() {
+    frame.capture(*game);
+    frame.winner = frame.turn;
+    renderWin(frame);
+}
+
+void GraphicObserver::renderWin(const Frame &frame) {
     /*
     window->fillRectangle(190, 15, 10, 11, Xwindow::Green);
     std::string winningMsg = "Player ";
-    winningMsg += std::to_string(game->getPlayerTurn() + 1);
+    winningMsg += std::to_string(frame.winner + 1);
     winningMsg += " has won!";
     window->drawString(190, 25, winningMsg);
     */
 }
 
+int GraphicObserver::playerLeft(int player) const {
+    return (GRIDLEFT + PLAYER_WIDTH * player) * 10 - 1;
+}
+
 // Print with blinded effect
-void GraphicObserver::print() {
+void GraphicObserver::render(const Frame &frame) {
+    Profile::Scope profile{Profile::GraphicRender};
     // Header
-    if (game->getHiScore() != prevHighScore) {
+    if (frame.hiScore != prevHighScore) {
         window->fillRectangle(50, 15, 135, 11, Xwindow::White);
-        window->drawString(54, 25, std::to_string(game->getHiScore()));
-        prevHighScore = game->getHiScore();
+        window->drawString(54, 25, std::to_string(frame.hiScore));
+        prevHighScore = frame.hiScore;
     }
-    if (game->getPlayerTurn() != prevPlayerIdx) {
-        window->fillRectangle(270, 15, 10, 11, Xwindow::White);
-        window->drawString(270, 25, std::to_string(2 - prevPlayerIdx));
-        prevPlayerIdx = 1 - prevPlayerIdx;
+    if (frame.turn != prevPlayerIdx) {
+        window->fillRectangle(10 * windowWidth - 10, 15, 10, 11, Xwindow::White);
+        window->drawString(10 * windowWidth - 10, 25, std::to_string(frame.turn + 1));
+        prevPlayerIdx = frame.turn;
     }
 
-    // Score + Level
-    if (game->getLevel(P0_IDX) != p0PrevLevel) {
-        window->fillRectangle(45, 33, 15, 11, Xwindow::White);
-        window->drawString(50, 43, std::to_string(game->getLevel(P0_IDX)));
-        p0PrevLevel = game->getLevel(P0_IDX); 
-    }
-    if (game->getScore(P0_IDX) != p0PrevScore) {
-        window->fillRectangle(45, 45, 80, 11, Xwindow::White);
-        window->drawString(50, 55, std::to_string(game->getScore(P0_IDX)));
-        p0PrevScore = game->getScore(P0_IDX);
-    }
-    if (game->getLevel(P1_IDX) != p1PrevLevel) {
-        window->fillRectangle(195, 33, 15, 11, Xwindow::White);
-        window->drawString(200, 43, std::to_string(game->getLevel(P1_IDX)));
-        p1PrevLevel = game->getLevel(P1_IDX); 
-    }
-    if (game->getScore(P1_IDX) != p1PrevScore) {
-        window->fillRectangle(195, 45, 80, 11, Xwindow::White);
-        window->drawString(200, 55, std::to_string(game->getScore(P1_IDX)));
-        p1PrevScore = game->getScore(P1_IDX);
-    }
-    
-
-    for (int i = 0; i < ROWS; ++i) {
-        // Grid1
-        for (int j = 0; j < COLS; ++j) {
-            char c = game->getState(P0_IDX,i,j);
-            // If it was the same symbol as before, skip
-            if (c == charGrid1[i][j]) {
-                continue;
-            }
-            else {
-                int colour = getColourForBlock(c);
-                window->fillRectangle((j + GRID1LEFT) * 10, (i + GRIDTOP) * 10, 10, 10, colour);
-                charGrid1[i][j] = c; // Update the new char
-            }
+    for (int p = 0; p < numPlayers; ++p) {
+        int left = playerLeft(p);
+
+        // Score + Level
+        if (frame.levels[p] != prevLevels[p]) {
+            window->fillRectangle(left + 36, 33, 15, 11, Xwindow::White);
+            window->drawString(left + 41, 43, std::to_string(frame.levels[p]));
+            prevLevels[p] = frame.levels[p];
+        }
+        if (frame.scores[p] != prevScores[p]) {
+            window->fillRectangle(left + 36, 45, 80, 11, Xwindow::White);
+            window->drawString(left + 41, 55, std::to_string(frame.scores[p]));
+            prevScores[p] = frame.scores[p];
         }
-        // Next Block 1 (Player 0)
-        for (int j = 0; j < NEXTCOLS; ++j) {
-            if (!((i >= 2) && (i <= 3))) break; // Only from index 2 to 3 (bottom 2 rows of the grid)
-            char c;
-            bool found = false;
-            for (int k = 0; k < 4; ++k) {
-                if (((game->getNextBlock(P0_IDX))->getCoords())[k].first == j && ((game->getNextBlock(P0_IDX))->getCoords())[k].second == i) {
-                    c = game->getNextBlock(P0_IDX)->getBlockSymbol();
-                    found = true;
+
+        std::vector<std::vector<char>> &charGrid = charGrids[p];
+        int gridLeft = GRIDLEFT + PLAYER_WIDTH * p;
+
+        for (int i = 0; i < ROWS; ++i) {
+            // Grid
+            for (int j = 0; j < COLS; ++j) {
+                char c = frame.cell(p, i, j);
+                // If it was the same symbol as before, skip
+                if (c == charGrid[i][j]) {
+                    continue;
                 }
-            }
-            if (found) {
-                if (nextGrid1[i][j] == c) break; // If same symbol, break
                 else {
                     int colour = getColourForBlock(c);
-                    window->fillRectangle((j + NEXT1LEFT) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, colour);
-                    nextGrid1[i][j] = c;// update the next grid 2
+                    window->fillRectangle((j + gridLeft) * 10, (i + GRIDTOP) * 10, 10, 10, colour);
+                    charGrid[i][j] = c; // Update the new char
                 }
             }
-            else {
-                if (nextGrid1[i][j] != ' ') { // Not found case. If it was not white, change it to white
-                    window->fillRectangle((j + NEXT1LEFT) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, Xwindow::White);
-                    nextGrid1[i][j] = ' '; // set to blank
-                } // Else leave it white
-            }
+            // Next Block
+            printNext(frame, p, i);
         }
-        // Grid2
-        for (int j = 0; j < 11; ++j) {
-            char c = game->getState(P1_IDX,i,j);
-            // If it was the same symbol as before, skip
-            if (c == charGrid2[i][j]) {
-                continue;
-            }
+    }
+}
+
+void GraphicObserver::printNext(const Frame &frame, int player, int i) {
+    std::vector<std::vector<char>> &nextGrid = nextGrids[player];
+    int nextLeft = NEXTLEFT + PLAYER_WIDTH * player;
+
+    for (int j = 0; j < NEXTCOLS; ++j) {
+        if (!((i >= 2) && (i <= 3))) break; // Only from index 2 to 3 (bottom 2 rows of the grid)
+        char c = frame.nextCell(player, i, j);
+        bool found = c != ' ';
+        if (found) {
+            if (nextGrid[i][j] == c) break; // If same symbol, break
             else {
                 int colour = getColourForBlock(c);
-                window->fillRectangle((j + GRID2LEFT) * 10, (i + GRIDTOP) * 10, 10, 10, colour);
-                charGrid2[i][j] = c; // Update the new char
+                window->fillRectangle((j + nextLeft) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, colour);
+                nextGrid[i][j] = c; // update the next grid
             }
         }
-        // Next Block 1 (Player 0)
-        for (int j = 0; j < NEXTCOLS; ++j) {
-            if (!((i >= 2) && (i <= 3))) break; // Only from index 2 to 3 (bottom 2 rows of the grid)
-            char c;
-            bool found = false;
-            for (int k = 0; k < 4; ++k) {
-                if (((game->getNextBlock(P1_IDX))->getCoords())[k].first == j && ((game->getNextBlock(P1_IDX))->getCoords())[k].second == i) {
-                    c = game->getNextBlock(P1_IDX)->getBlockSymbol();
-                    found = true;
-                }
-            }
-            if (found) {
-                if (nextGrid2[i][j] == c) break; // If same symbol, break
-                else {
-                    int colour = getColourForBlock(c);
-                    window->fillRectangle((j + NEXT2LEFT) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, colour);
-                    nextGrid2[i][j] = c; // update the next grid 2
-                }
-            }
-            else {
-                if (nextGrid2[i][j] != ' ') { // Not found case. If it was not white, change it to white
-                    window->fillRectangle((j + NEXT2LEFT) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, Xwindow::White);
-                    nextGrid2[i][j] = ' '; // set to blank
-                } // Else leave it white
-            }
+        else {
+            if (nextGrid[i][j] != ' ') { // Not found case. If it was not white, change it to white
+                window->fillRectangle((j + nextLeft) * 10, (i + NEXTGRIDTOP) * 10, 10, 10, Xwindow::White);
+                nextGrid[i][j] = ' '; // set to blank
+            } // Else leave it white
         }
     }
 }
@@ -0,0 +1,119 @@
+#include "inputReader.h"
+#include "trace.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+InputReader::Buffer::Buffer(SpscQueue<std::string, CHUNKS> &chunks): chunks{chunks}, ended{false} {}
+
+InputReader::Buffer::int_type InputReader::Buffer::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    // the end of the input stays the end, however many times it is read
+    else if (ended) return traits_type::eof();
+
+    current = chunks.pop();
+
+    if (current.empty()) {
+        ended = true;
+        return traits_type::eof();
+    }
+
+    setg(current.data(), current.data(), current.data() + current.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+InputReader::InputReader(int fd):
+    fd{fd}, ownsFd{false}, buffer{chunks}, in{&buffer}, finished{false}, replaced{nullptr}, original{nullptr} {
+    if (pipe(wakeFds) != 0) wakeFds[0] = wakeFds[1] = -1;
+
+    reader = std::thread{&InputReader::readLoop, this};
+}
+
+// Opening a FIFO for reading normally waits for a writer, which would make a
+// Player's input wait on the other's, so it is opened without blocking and
+// the reading thread waits for data instead
+InputReader::InputReader(const std::string &path): InputReader{open(path.c_str(), O_RDONLY | O_NONBLOCK)} {
+    ownsFd = fd != -1;
+}
+
+InputReader::~InputReader() {
+    if (replaced) replaced->rdbuf(original);
+
+    // without a way to wake it up, the thread could be waiting forever for
+    // input that never comes (e.g. from a terminal), so it is left behind
+    if (wakeFds[1] == -1) {
+        reader.detach();
+        return;
+    }
+
+    char c = 0;
+
+    while (write(wakeFds[1], &c, 1) < 0 && errno == EINTR) {}
+
+    // the thread may also be waiting for room in the ring
+    std::string chunk;
+
+    while (!finished.load(std::memory_order_acquire)) {
+        while (chunks.tryPop(chunk)) {}
+
+        std::this_thread::yield();
+    }
+
+    reader.join();
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+
+    if (ownsFd) close(fd);
+}
+
+void InputReader::readLoop() {
+    std::string chunk(CHUNK_SIZE, '\0');
+
+    Trace::nameThread("input reader");
+
+    // nothing to read from
+    if (fd == -1) {
+        chunks.push("");
+        finished.store(true, std::memory_order_release);
+        return;
+    }
+
+    while (true) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+
+        if (poll(fds, wakeFds[0] != -1 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            else break;
+        }
+
+        if (fds[1].revents) break;
+
+        // takes whatever is there, so a line typed at a terminal is handed
+        // over at once and a pipe is read in large chunks
+        ssize_t n;
+
+        {
+            Trace::Span trace{"input", "read"};
+            n = read(fd, chunk.data(), CHUNK_SIZE);
+        }
+
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        else if (n <= 0) break;
+
+        chunks.push(chunk.substr(0, n));
+    }
+
+    chunks.push("");
+    finished.store(true, std::memory_order_release);
+}
+
+bool InputReader::isOpen() const { return fd != -1; }
+
+std::istream &InputReader::stream() { return in; }
+
+void InputReader::replace(std::istream &s) {
+    replaced = &s;
+    original = s.rdbuf(&buffer);
+}
@@ -0,0 +1,102 @@
+#include "keyboardInput.h"
+#include "trace.h"
+#include "window.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+KeyboardInput::KeyboardInput(const Xwindow &window):
+    display{XOpenDisplay(nullptr)}, window{window.getWindow()},
+    wakeFd{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}, stopFd{eventfd(0, EFD_CLOEXEC)}, dropped{0} {
+    if (!display || wakeFd == -1 || stopFd == -1) return;
+
+    // any number of clients may select the key presses of the same window
+    XSelectInput(display, this->window, KeyPressMask);
+    XFlush(display);
+
+    events = std::thread{&KeyboardInput::eventLoop, this};
+}
+
+KeyboardInput::~KeyboardInput() {
+    if (events.joinable()) {
+        uint64_t one = 1;
+
+        while (write(stopFd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+
+        events.join();
+    }
+
+    if (wakeFd != -1) close(wakeFd);
+    if (stopFd != -1) close(stopFd);
+    if (display) XCloseDisplay(display);
+}
+
+bool KeyboardInput::isOpen() const { return events.joinable(); }
+
+int KeyboardInput::fd() const { return wakeFd; }
+
+const char *KeyboardInput::commandFor(unsigned long keysym) {
+    switch (keysym) {
+        case XK_Left: return "left";
+        case XK_Right: return "right";
+        case XK_Down: return "down";
+        case XK_Up:
+        case XK_x: return "clockwise";
+        case XK_z: return "counterclockwise";
+        case XK_space: return "drop";
+        default: return nullptr;
+    }
+}
+
+bool KeyboardInput::pop(Press &press) {
+    if (presses.tryPop(press)) return true;
+
+    // the counter is only reset once the ring is seen empty, so a press pushed
+    // in between always leaves 'fd()' readable
+    uint64_t count;
+
+    while (read(wakeFd, &count, sizeof(count)) < 0 && errno == EINTR) {}
+
+    return presses.tryPop(press);
+}
+
+uint64_t KeyboardInput::droppedPresses() const { return dropped.load(std::memory_order_relaxed); }
+
+void KeyboardInput::eventLoop() {
+    pollfd fds[2] = {{ConnectionNumber(display), POLLIN, 0}, {stopFd, POLLIN, 0}};
+
+    Trace::nameThread("keyboard");
+
+    while (true) {
+        // events Xlib already read off the connection do not wake 'poll' up
+        while (XPending(display)) {
+            XEvent ev;
+            XNextEvent(display, &ev);
+
+            if (ev.type != KeyPress) continue;
+
+            Clock::time_point read = Clock::now();
+            const char *command = commandFor(XLookupKeysym(&ev.xkey, 0));
+
+            if (!command) continue;
+
+            if (!presses.tryPush(Press{command, read})) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            uint64_t one = 1;
+
+            while (write(wakeFd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+        }
+
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) return;
+
+        // stopped, or the X server went away
+        if (fds[1].revents || fds[0].revents & (POLLERR | POLLHUP)) return;
+    }
+}
@@ -1,33 +1,15 @@
 #include "level0.h"
 
-Level0::Level0(const int l, std::string s): Level{l}, seq{s}, f{seq} {}
+Level0::Level0(const int l, std::shared_ptr<const BlockSequence> s): Level{l}, seq{s}, next{0} {}
 
 char Level0::produceBlock() {
-    char c;
-    
-    // as long as the input file stream finds a character, we read it
-    while (f.get(c)) {
-        // if it's the newline character, skip over it
-        if (c == '\n') continue;
-        else return c;
-    }
+    // upon reaching the end of the sequence, we start from its beginning again
+    if (next >= seq->size()) next = 0;
 
-    // upon reaching EOF, we would have to go back to the beginning of the file
-    // and start reading from there again
-    f.clear();
-    f.seekg(0);
-
-    // finding the first non-newline character, and returning it
-    while (f.get(c)) {
-        if (c == '\n') continue;
-        else return c;
-    }
-
-    // technically should never get here, unless we get an erroneous empty text file
-    // as input
-    return 0;
+    // an empty sequence (e.g. a missing file) gives 0, as there is no Block to return
+    return seq->at(next++);
 }
 
-Level0::~Level0() {
-    f.close();
-}
+void Level0::restart() { next = 0; }
+
+Level0::~Level0() {}
@@ -0,0 +1,430 @@
+#include "perft.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+
+// Boards the kernels are checked on, not a multiple of BoardBatch::LANES so
+// the last chunk is only partly used
+static const int KERNEL_CHECK_BOARDS = 4099;
+
+Perft::Perft(std::vector<char> pieces, int level, size_t hashMegabytes, int threads):
+    level{level}, pieces{pieces}, threads{std::max(threads, 1)} {
+    // the Player only serves as the owner of the Blocks, it is never asked for one
+    player = std::make_unique<Player>("", level, random);
+
+    for (char type : pieces) {
+        if (!spawns.count(type)) spawns[type] = createBlock(type)->getCoords();
+    }
+
+    if (hashMegabytes > 0) tt = std::make_unique<TranspositionTable>(hashMegabytes);
+}
+
+BlockRef Perft::createBlock(char type) {
+    Player *p = player.get();
+
+    if (type == 'I')
+        return blocks.make<IBlock>(level, p);
+    else if (type == 'J')
+        return blocks.make<JBlock>(level, p);
+    else if (type == 'L')
+        return blocks.make<LBlock>(level, p);
+    else if (type == 'O')
+        return blocks.make<OBlock>(level, p);
+    else if (type == 'S')
+        return blocks.make<SBlock>(level, p);
+    else if (type == 'Z')
+        return blocks.make<ZBlock>(level, p);
+    else
+        return blocks.make<TBlock>(level, p);
+}
+
+char Perft::pieceAt(int ply) const { return pieces[ply % pieces.size()]; }
+
+// The moves are numbered like in Reachability: left, right, down, clockwise
+// and counterclockwise
+bool Perft::referenceMove(Board &board, int move, int mult) const {
+    for (int i = 0; i < mult; ++i) {
+        if (move == 0) board.moveBlock("l");
+        else if (move == 1) board.moveBlock("r");
+        else if (move == 2) board.moveBlock("d");
+        else if (move == 3) board.rotateBlock("CW");
+        else board.rotateBlock("CCW");
+    }
+
+    if (level < 3) return false;
+
+    // Level Heavy, same as Game::applyHeavy
+    if (!board.tryMoveBlock("d")) return true;
+
+    board.moveBlock("d");
+
+    return false;
+}
+
+std::vector<Board> Perft::referenceChildren(const Board &board, char type) {
+    std::vector<Board> res;
+    Board start = board;
+    start.setNewCurrentBlock(createBlock(type));
+
+    // the Block cannot even be placed, so the game is lost
+    if (!start.tryPlaceBlock()) return res;
+
+    start.placeBlock();
+    checkHash(start);
+
+    // without Heavy a multiplier is the same as repeating the command, and with
+    // it any multiplier past the size of the Board (or a full turn) can no
+    // longer change anything
+    auto maxMult = [this](int move) {
+        if (level < 3) return 1;
+        else if (move == 2) return ROWS - 1;
+        else if (move > 2) return 3;
+        else return COLS - 1;
+    };
+
+    std::set<std::vector<std::pair<int, int>>> visited;
+    std::set<std::string> seen;
+    std::vector<Board> queue{start};
+    visited.insert(start.currentBlock->getCoords());
+
+    // copies a Board along with its own copy of the current Block, so moving it
+    // does not move the Block of the original (which stays on the grid, so it
+    // is not set as a new one)
+    auto copy = [this](const Board &b) {
+        Board res = b;
+        res.currentBlock = b.currentBlock->clone(blocks);
+        return res;
+    };
+
+    // settles the Block and keeps the Board if it was not reached before,
+    // checking its features against those predicted from 'from', the Board
+    // it was moved from
+    auto settle = [&](Board &b, const Board &from) {
+        BoardFeatures predicted = from.evaluatePlacement(b.currentBlock->getCoords());
+
+        b.setNewCurrentBlock(nullptr);
+        checkFeatures(b, predicted, b.clearFullRows());
+        checkHash(b);
+
+        std::string key;
+
+        for (int i = 0; i < ROWS; ++i) {
+            for (int j = 0; j < COLS; ++j) key += b.charAt(i, j) == ' ' ? '.' : '#';
+        }
+
+        if (seen.insert(key).second) res.push_back(b);
+    };
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Board dropped = copy(queue[head]);
+        dropped.dropBlock();
+        settle(dropped, queue[head]);
+
+        for (int move = 0; move < 5; ++move) {
+            for (int mult = 1; mult <= maxMult(move); ++mult) {
+                Board next = copy(queue[head]);
+
+                if (referenceMove(next, move, mult)) {
+                    settle(next, queue[head]);
+                } else if (visited.insert(next.currentBlock->getCoords()).second) {
+                    checkHash(next);
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+void Perft::checkFeatures(const Board &board, const BoardFeatures &predicted, int cleared) {
+    BoardFeatures expected = BoardFeatures::fromRows(board.rowMasks);
+    BoardFeatures kept = board.getFeatures();
+
+    expected.linesCleared = kept.linesCleared = cleared;
+    ++featureChecks;
+
+    if (kept != expected || predicted != expected) ++featureMismatches;
+}
+
+void Perft::checkHash(const Board &board) {
+    uint64_t all = 0, falling = 0;
+
+    for (int i = 0; i < ROWS; ++i) {
+        for (int j = 0; j < COLS; ++j) {
+            if (board.grid[i][j].getIsOccupied()) all ^= Zobrist::key(i, j);
+        }
+    }
+
+    if (board.currentBlock) {
+        for (const auto &tile : board.currentBlock->getCoords()) falling ^= Zobrist::key(tile.second, tile.first);
+    }
+
+    ++hashChecks;
+
+    if (board.getHash() != (all ^ falling) || Zobrist::hash(board.rowMasks) != all) ++hashMismatches;
+}
+
+bool Perft::checkKernels(std::ostream &out) {
+    // a fixed seed, so that a failure can be reproduced
+    std::mt19937 rng{KERNEL_CHECK_BOARDS};
+    std::vector<RowMasks> boards, cleared;
+    std::vector<int> clearedCounts;
+    uint64_t mismatches = 0;
+
+    // full and empty rows are made common, the top one included, as clearing
+    // them is where the kernels differ the most from the scalar loop
+    for (int b = 0; b < KERNEL_CHECK_BOARDS; ++b) {
+        RowMasks rows;
+
+        for (int r = 0; r < ROWS; ++r) {
+            switch (rng() % 4) {
+                case 0: rows[r] = FULL_ROW_MASK; break;
+                case 1: rows[r] = 0; break;
+                default: rows[r] = rng() & FULL_ROW_MASK;
+            }
+        }
+
+        // the expected result, which must also be what a Board does
+        RowMasks after = rows;
+        int count = ::clearFullRows<ROWS, COLS>(after);
+        Board board;
+
+        for (int r = 0; r < ROWS; ++r) {
+            for (int c = 0; c < COLS; ++c) {
+                if (rows[r] & (1 << c)) board.setTile(r, c, Tile{'#', true});
+            }
+        }
+
+        if (board.clearFullRows() != count || board.rowMasks != after) ++mismatches;
+
+        boards.push_back(rows);
+        cleared.push_back(after);
+        clearedCounts.push_back(count);
+    }
+
+    std::string checked;
+
+    for (auto k : {BoardBatch::Kernels::Scalar, BoardBatch::Kernels::SSE2, BoardBatch::Kernels::AVX2}) {
+        BoardBatch batch;
+        batch.useKernels(k);
+
+        // not supported by this CPU
+        if (batch.getKernels() != k) continue;
+
+        for (const auto &rows : boards) batch.push(rows);
+
+        std::vector<uint32_t> full;
+        std::vector<std::array<uint8_t, MASK_COLS>> heights;
+        std::vector<int> holes, counts;
+
+        batch.fullRows(full);
+        batch.columnHeights(heights);
+        batch.holes(holes);
+        batch.clearFullRows(counts);
+
+        for (size_t i = 0; i < boards.size(); ++i) {
+            BoardFeatures features = BoardFeatures::fromRows(boards[i]);
+            uint32_t fullRows = 0;
+
+            for (int r = 0; r < ROWS; ++r) {
+                if (boards[i][r] == FULL_ROW_MASK) fullRows |= 1u << r;
+            }
+
+            bool same = full[i] == fullRows && holes[i] == features.totalHoles &&
+                        counts[i] == clearedCounts[i] && batch.get(i) == cleared[i];
+
+            for (int c = 0; c < COLS; ++c) same = same && heights[i][c] == features.heights[c];
+
+            if (!same) ++mismatches;
+        }
+
+        checked += checked.empty() ? "" : ", ";
+        checked += BoardBatch::kernelsName(k);
+    }
+
+    out << "kernels: " << checked << " checked on " << boards.size() << " Boards, "
+        << mismatches << " mismatches" << std::endl;
+
+    return mismatches == 0;
+}
+
+uint64_t Perft::referenceCount(const Board &board, int ply, int depth) {
+    std::vector<Board> children = referenceChildren(board, pieceAt(ply));
+
+    if (depth == 1) return children.size();
+
+    uint64_t count = 0;
+
+    for (const auto &child : children) count += referenceCount(child, ply + 1, depth - 1);
+
+    return count;
+}
+
+std::vector<Perft::Node> Perft::fastChildren(const Node &node, char type) {
+    std::vector<Node> res;
+    std::set<RowMasks> seen;
+    BoardBatch batch;
+    std::vector<int> cleared;
+    // the hash of each child before its rows are cleared
+    std::vector<uint64_t> hashes;
+
+    Reachability search{spawns.at(type), node.rows, level, false};
+
+    // the full rows of all the children are cleared together
+    for (const auto &placement : search.search()) {
+        RowMasks child = node.rows;
+        uint64_t hash = node.hash;
+
+        for (const auto &tile : placement.coords) {
+            child[tile.second] |= 1 << tile.first;
+            hash ^= Zobrist::key(tile.second, tile.first);
+        }
+
+        batch.push(child);
+        hashes.push_back(hash);
+    }
+
+    batch.clearFullRows(cleared);
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        RowMasks child = batch.get(i);
+
+        // clearing rows moves every Tile above them, so the hash is redone
+        if (seen.insert(child).second) res.push_back({child, cleared[i] ? Zobrist::hash(child) : hashes[i]});
+    }
+
+    return res;
+}
+
+uint64_t Perft::subtreeKey(uint64_t boardHash, int ply, int depth) const {
+    // exactly the Blocks placed below the Board: the current one, the next one
+    // unless the current one is the last, then the others and how many there are
+    uint64_t rest = depth;
+
+    for (int i = 2; i < depth; ++i) rest = (rest ^ static_cast<unsigned char>(pieceAt(ply + i))) * 0x100000001B3ULL;
+
+    return TranspositionTable::positionKey(boardHash ^ rest * 0x9E3779B97F4A7C15ULL, pieceAt(ply),
+                                           depth > 1 ? pieceAt(ply + 1) : '\0');
+}
+
+uint64_t Perft::fastCount(const Node &node, int ply, int depth) {
+    std::vector<Node> children = fastChildren(node, pieceAt(ply));
+
+    if (depth == 1) return children.size();
+
+    uint64_t count = 0;
+
+    for (const auto &child : children) count += cachedCount(child, ply + 1, depth - 1);
+
+    return count;
+}
+
+uint64_t Perft::cachedCount(const Node &node, int ply, int depth) {
+    if (!tt) return fastCount(node, ply, depth);
+
+    uint64_t key = subtreeKey(node.hash, ply, depth);
+    uint64_t value;
+    int storedDepth;
+
+    if (tt->probe(key, value, storedDepth) && storedDepth == depth) return value;
+
+    value = fastCount(node, ply, depth);
+    tt->store(key, value, depth);
+
+    return value;
+}
+
+uint64_t Perft::reference(int depth) {
+    if (depth <= 0) return 1;
+
+    return referenceCount(Board{}, 0, depth);
+}
+
+uint64_t Perft::fast(int depth) {
+    if (depth <= 0) return 1;
+    else if (depth == 1 || threads == 1) return fastCount(Node{}, 0, depth);
+
+    // the Boards after the first Block are split between the threads, which
+    // share what they find through the transposition table
+    std::vector<Node> children = fastChildren(Node{}, pieceAt(0));
+    std::vector<uint64_t> counts(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < children.size(); i += threads) {
+                counts[t] += cachedCount(children[i], 1, depth - 1);
+            }
+        });
+    }
+
+    uint64_t count = 0;
+
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+        count += counts[t];
+    }
+
+    return count;
+}
+
+bool Perft::run(int depth, std::ostream &out) {
+    using Clock = std::chrono::steady_clock;
+    bool match = true;
+
+    // nodes per second, guarding against runs too quick for the clock
+    auto rate = [](uint64_t nodes, double secs) {
+        return secs > 0 ? static_cast<uint64_t>(nodes / secs) : nodes;
+    };
+
+    for (int d = 1; d <= depth; ++d) {
+        auto t0 = Clock::now();
+        uint64_t ref = reference(d);
+        auto t1 = Clock::now();
+        uint64_t opt = fast(d);
+        auto t2 = Clock::now();
+
+        double refSecs = std::chrono::duration<double>(t1 - t0).count();
+        double optSecs = std::chrono::duration<double>(t2 - t1).count();
+
+        out << "perft " << d << ": " << ref
+            << " (reference " << refSecs << "s, " << rate(ref, refSecs) << " nodes/s; "
+            << "fast " << optSecs << "s, " << rate(opt, optSecs) << " nodes/s)" << std::endl;
+
+        if (ref != opt) {
+            out << "MISMATCH at depth " << d << ": reference " << ref << ", fast " << opt << std::endl;
+            match = false;
+        }
+    }
+
+    out << "features: " << featureChecks << " Boards checked, " << featureMismatches << " mismatches" << std::endl;
+
+    if (featureMismatches > 0) match = false;
+
+    out << "zobrist: " << hashChecks << " Boards checked, " << hashMismatches << " mismatches" << std::endl;
+
+    if (hashMismatches > 0) match = false;
+
+    out << "batch kernels: " << BoardBatch::kernelsName(BoardBatch::bestKernels()) << std::endl;
+
+    if (!checkKernels(out)) match = false;
+    // the reference search makes a Block for every position it tries, all in
+    // the few slots the pool grew to at the start
+    out << "blocks: " << blocks.blocksCreated() << " made in " << blocks.capacity() << " slots ("
+        << blocks.chunkAllocations() << " allocations)" << std::endl;
+
+    if (tt) {
+        TranspositionTable::Stats stats = tt->stats();
+
+        out << "hash: " << stats.hits << "/" << stats.probes << " hits ("
+            << 100 * stats.hitRate() << "%), " << stats.stores << " stores, "
+            << stats.overwrites << " overwrites, " << tt->capacity() << " entries" << std::endl;
+    }
+
+    return match;
+}
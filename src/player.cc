@@ -1,14 +1,33 @@
 #include "player.h"
 
-Player::Player(std::string s, int startLevel): score{0}, lvl4LastClearRow{0}, seq{s} {
-    pol = std::make_unique<ProbsOfLevels>();
+Player::Player(std::string s, int startLevel, Random &random):
+    score{0}, lvl4LastClearRow{0}, seq{BlockSequence::load(s)}, l{nullptr}, lastProbs{nullptr} {
+    level0 = std::make_unique<Level0>(LOWEST_LVL, seq);
+
+    for (int level = LOWEST_LVL + 1; level <= HIGHEST_LVL; ++level) {
+        probsLevels.push_back(std::make_unique<ProbsLevel>(level, ProbsOfLevels::obtainLvlProb(level), random));
+    }
+
     setLevel(startLevel);
 }
 
 void Player::setLevel(int level) {
     if (level < LOWEST_LVL || level > HIGHEST_LVL) return;
-    else if (level == 0) l = std::make_unique<Level0>(level, seq);
-    else l = std::make_unique<ProbsLevel>(level, pol->obtainLvlProb(level));
+    else if (level == 0) {
+        // coming back to Level 0 starts its sequence over, as it always did
+        if (l != level0.get()) level0->restart();
+
+        l = level0.get();
+        return;
+    }
+
+    ProbsLevel *next = probsLevels[level - 1].get();
+
+    // the 'norandom' settings follow the Player from one random Level to the
+    // next, even when going through Level 0
+    if (lastProbs && lastProbs != next) next->followNoRand(*lastProbs);
+
+    l = lastProbs = next;
 }
 
 int Player::getScore() const { return score; }
@@ -23,6 +42,11 @@ char Player::getBlock() const { return l->produceBlock(); }
 
 void Player::restart() {
     score = 0;
+    level0->restart();
+
+    for (auto &level : probsLevels) level->setRand();
+
+    lastProbs = nullptr;
     setLevel(getLevel());
     lvl4LastClearRow = 0;
 }
@@ -1,8 +1,8 @@
 #include "probsLevel.h"
 #include <iostream>
 
-ProbsLevel::ProbsLevel(const int l, const std::vector<float> p):
-    Level{l}, probs(NUM_BLOCKS, 0), noRand{false}, seq{""} {
+ProbsLevel::ProbsLevel(const int l, const std::vector<float> &p, Random &random):
+    Level{l}, probs(NUM_BLOCKS, 0), noRand{false}, seq{std::make_shared<BlockSequence>()}, next{0}, random{&random} {
     int OTHER_BLOCKS = NUM_BLOCKS;
     float leftover = total;
 
@@ -32,17 +32,12 @@ ProbsLevel::ProbsLevel(const int l, const std::vector<float> p):
 
 void ProbsLevel::setNoRand(std::string sequence) {
     noRand = true;
-
-    if (f.is_open()) f.close();
-
-    seq = sequence;
-    f.open(seq);
+    seq = BlockSequence::load(sequence);
+    next = 0;
 }
 
 void ProbsLevel::setRand() {
     noRand = false;
-    
-    if (f.is_open()) f.close();
 }
 
 char ProbsLevel::produceBlock() {
@@ -51,7 +46,7 @@ char ProbsLevel::produceBlock() {
 }
 
 char ProbsLevel::produceRandBlock() {
-    float randVal = static_cast<float>(rand()) / RAND_MAX * total;
+    float randVal = static_cast<float>(random->next()) / Random::MAX * total;
     float cumulativeProb = 0.0f;
 
     for (int i = 0; i < NUM_BLOCKS; ++i) {
@@ -69,35 +64,21 @@ char ProbsLevel::produceRandBlock() {
 }
 
 char ProbsLevel::produceNoRandBlock() {
-    char c;
-    
-    // as long as the input file stream finds a character, we read it
-    while (f.get(c)) {
-        // if it's the newline character, skip over it
-        if (c == '\n') continue;
-        else return c;
-    }
-
-    // upon reaching EOF, we would have to go back to the beginning of the file
-    // and start reading from there again
-    f.clear();
-    f.seekg(0);
+    // upon reaching the end of the sequence, we start from its beginning again
+    if (next >= seq->size()) next = 0;
 
-    // finding the first non-newline character, and returning it
-    while (f.get(c)) {
-        if (c == '\n') continue;
-        else return c;
-    }
-
-    // technically should never get here, unless we get an erroneous empty text file
-    // as input
-    return 0;
+    // an empty sequence (e.g. a missing file) gives 0, as there is no Block to return
+    return seq->at(next++);
 }
 
 bool ProbsLevel::isNoRand() { return noRand; }
 
-std::string ProbsLevel::noRandSeq() { return seq; }
+std::string ProbsLevel::noRandSeq() { return seq->getFile(); }
 
-ProbsLevel::~ProbsLevel() {
-    if (f.is_open()) f.close();
+void ProbsLevel::followNoRand(const ProbsLevel &other) {
+    noRand = other.noRand;
+    seq = other.seq;
+    next = other.next;
 }
+
+ProbsLevel::~ProbsLevel() {}
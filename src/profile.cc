@@ -0,0 +1,89 @@
+#include "profile.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <pthread.h>
+#include <thread>
+
+static const char *const NAMES[] = {
+    "parseCommand", "tryMoveBlock", "tryRotateBlock", "dropBlock", "clearFullRows",
+    "TextObserver", "GraphicObserver", "turns"
+};
+static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == Profile::NumCounters, "every counter needs a name");
+
+std::atomic<bool> Profile::enabled{false};
+Profile::Stat Profile::stats[Profile::NumCounters];
+std::atomic<uint64_t> Profile::allocations{0};
+std::atomic<uint64_t> Profile::allocatedBytes{0};
+
+// Every allocation of the program goes through here (the array and nothrow
+// versions call it too), counted only once the counters are on
+void *operator new(size_t size) {
+    if (Profile::isEnabled()) Profile::countAllocation(size);
+
+    if (void *p = std::malloc(size ? size : 1)) return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void Profile::enable() {
+    // blocked in this thread and every thread started after it, so that only
+    // the thread below ever gets it, where printing is safe
+    sigset_t usr1;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &usr1, nullptr);
+
+    std::thread{[usr1] {
+        int sig;
+
+        while (sigwait(&usr1, &sig) == 0) report(std::cerr);
+    }}.detach();
+
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Profile::count(Counter counter) {
+    if (isEnabled()) stats[counter].calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profile::countAllocation(size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Profile::record(Counter counter, Clock::duration time) {
+    stats[counter].calls.fetch_add(1, std::memory_order_relaxed);
+    stats[counter].nanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+                                   std::memory_order_relaxed);
+}
+
+void Profile::report(std::ostream &out) {
+    uint64_t turns = stats[Turns].calls.load(std::memory_order_relaxed);
+
+    out << "profile:" << std::endl;
+
+    for (int c = 0; c < Turns; ++c) {
+        uint64_t calls = stats[c].calls.load(std::memory_order_relaxed);
+        uint64_t nanos = stats[c].nanos.load(std::memory_order_relaxed);
+
+        out << "  " << std::left << std::setw(16) << NAMES[c] << std::right
+            << std::setw(10) << calls << " calls " << std::setw(12) << nanos / 1000 << "us total "
+            << std::setw(9) << (calls ? nanos / calls : 0) << "ns each" << std::endl;
+    }
+
+    uint64_t allocs = allocations.load(std::memory_order_relaxed);
+
+    out << "  " << turns << " turns, " << allocs << " heap allocations ("
+        << allocatedBytes.load(std::memory_order_relaxed) << " bytes)";
+
+    if (turns) out << ", " << allocs / turns << " per turn";
+
+    out << std::endl;
+}
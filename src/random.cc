@@ -0,0 +1,38 @@
+#include "random.h"
+
+Random::Random(unsigned seed) {
+    std::array<uint32_t, DEGREE + SEPARATION> r;
+    // glibc replaces a seed of 0, which would give only zeros
+    r[0] = seed ? seed : 1;
+
+    // Park-Miller, computed without overflowing as glibc does
+    for (int i = 1; i < DEGREE; ++i) {
+        int32_t prev = r[i - 1];
+        int32_t word = 16807 * (prev % 127773) - 2836 * (prev / 127773);
+
+        r[i] = word < 0 ? word + MAX : word;
+    }
+
+    for (int i = DEGREE; i < DEGREE + SEPARATION; ++i) r[i] = r[i - DEGREE];
+
+    for (int i = SEPARATION; i < DEGREE + SEPARATION; ++i) state[i % DEGREE] = r[i];
+
+    n = DEGREE + SEPARATION;
+
+    // the first values are skipped, as they still depend too much on the seed
+    for (int i = 0; i < 10 * DEGREE; ++i) step();
+}
+
+uint32_t Random::step() {
+    uint32_t value = state[n % DEGREE] + state[(n - SEPARATION) % DEGREE];
+
+    state[n % DEGREE] = value;
+    ++n;
+
+    // keeps 'n' small, without changing where the values are
+    if (n == 2 * DEGREE) n = DEGREE;
+
+    return value;
+}
+
+int Random::next() { return step() >> 1; }
@@ -0,0 +1,240 @@
+#include "reachability.h"
+#include "board.h"
+#include <algorithm>
+
+Reachability::Reachability(const Board &board, int level, bool heavySpecAct):
+    Reachability{board.currentBlock->getCoords(), settledRows(board), level, heavySpecAct} {}
+
+Reachability::Reachability(const std::vector<std::pair<int, int>> &blockCoords,
+                           const RowMasks &occupied, int level, bool heavySpecAct):
+    occupied{occupied},
+    levelHeavy{level >= HEAVY_LVL ? HEAVY_LVL_DOWN : 0},
+    specActHeavy{heavySpecAct ? HEAVY_SPEC_ACT_DOWN : 0} {
+    buildShapes(blockCoords);
+
+    // the Block starts with its bottom-left corner wherever it currently is
+    startX = blockCoords[0].first;
+    startY = blockCoords[0].second;
+
+    for (const auto &tile : blockCoords) {
+        startX = std::min(startX, tile.first);
+        startY = std::max(startY, tile.second);
+    }
+}
+
+// Bitmasks of the Tiles on the Board, leaving out the current Block itself
+RowMasks Reachability::settledRows(const Board &board) {
+    RowMasks rows = board.rowMasks;
+
+    for (const auto &tile : board.currentBlock->getCoords()) {
+        rows[tile.second] &= ~(1 << tile.first);
+    }
+
+    return rows;
+}
+
+int Reachability::encode(int x, int y, int rot) { return (rot * ROWS + y) * COLS + x; }
+
+std::string Reachability::commandName(int move, int mult) {
+    static const std::string names[NUM_MOVES] = {
+        "left", "right", "down", "clockwise", "counterclockwise", "drop"};
+
+    if (mult > 1) return std::to_string(mult) + names[move];
+    else return names[move];
+}
+
+// Computes all four orientations of the Block the same way Block::rotate does:
+// a clockwise turn maps (x, y) to (-y, x) and a counterclockwise one maps it to
+// (y, -x), and either way the bottom-left corner of the bounding box stays put
+void Reachability::buildShapes(const std::vector<std::pair<int, int>> &coords) {
+    std::vector<std::pair<int, int>> cells = coords;
+
+    for (int r = 0; r < ROTATIONS; ++r) {
+        int minX = cells[0].first, maxX = cells[0].first;
+        int minY = cells[0].second, maxY = cells[0].second;
+
+        for (const auto &cell : cells) {
+            minX = std::min(minX, cell.first);
+            maxX = std::max(maxX, cell.first);
+            minY = std::min(minY, cell.second);
+            maxY = std::max(maxY, cell.second);
+        }
+
+        Shape &shape = shapes[r];
+        shape.numCells = cells.size();
+        shape.width = maxX - minX + 1;
+        shape.height = maxY - minY + 1;
+        shape.rowBits.fill(0);
+
+        for (int i = 0; i < shape.numCells; ++i) {
+            int dx = cells[i].first - minX;
+            int dy = cells[i].second - maxY;
+            shape.cells[i] = {dx, dy};
+            shape.rowBits[-dy] |= 1 << dx;
+        }
+
+        std::sort(shape.cells.begin(), shape.cells.begin() + shape.numCells);
+
+        // the next orientation is one clockwise turn away from this one
+        for (auto &cell : cells) cell = {-cell.second, cell.first};
+    }
+
+    for (int r = 0; r < ROTATIONS; ++r) {
+        canonRot[r] = r;
+
+        for (int c = 0; c < r; ++c) {
+            if (std::equal(shapes[r].cells.begin(), shapes[r].cells.begin() + shapes[r].numCells,
+                           shapes[c].cells.begin())) {
+                canonRot[r] = c;
+                break;
+            }
+        }
+    }
+}
+
+bool Reachability::fits(int x, int y, int rot) const {
+    const Shape &shape = shapes[rot];
+
+    // out of the Board, same as the bounds checks of Board::tryMoveBlock
+    if (x < 0 || x + shape.width > COLS || y >= ROWS || y - shape.height + 1 < 0) return false;
+
+    for (int k = 0; k < shape.height; ++k) {
+        if (occupied[y - k] & (shape.rowBits[k] << x)) return false;
+    }
+
+    return true;
+}
+
+bool Reachability::apply(int &x, int &y, int &rot, Move move, int mult) const {
+    for (int i = 0; i < mult; ++i) {
+        // same as Board::moveBlock and Board::rotateBlock, a move that does not
+        // fit is simply ignored
+        if (move == LEFT && fits(x - 1, y, rot)) --x;
+        else if (move == RIGHT && fits(x + 1, y, rot)) ++x;
+        else if (move == DOWN && fits(x, y + 1, rot)) ++y;
+        else if (move == CW || move == CCW) {
+            int next = canonRot[(rot + (move == CW ? 1 : ROTATIONS - 1)) % ROTATIONS];
+
+            if (fits(x, y, next)) rot = next;
+        }
+    }
+
+    // the Heavy property is applied once per command, no matter the multiplier
+    int heavyMoves = levelHeavy;
+
+    if (move == LEFT || move == RIGHT) heavyMoves += specActHeavy;
+
+    for (int i = 0; i < heavyMoves; ++i) {
+        if (!fits(x, y + 1, rot)) return true;
+
+        ++y;
+    }
+
+    return false;
+}
+
+// Without any Heavy 'down' after a command, a multiplier is the same as
+// repeating the command, so only the multiplier of 1 needs to be searched.
+// Otherwise any multiplier up to the point where repeating the move can no
+// longer change anything may lead somewhere new.
+int Reachability::maxMultiplier(Move move) const {
+    int heavyMoves = levelHeavy;
+
+    if (move == LEFT || move == RIGHT) heavyMoves += specActHeavy;
+
+    if (heavyMoves == 0) return 1;
+    else if (move == LEFT || move == RIGHT) return COLS - 1;
+    else if (move == DOWN) return ROWS - 1;
+    else return ROTATIONS - 1;
+}
+
+void Reachability::addPlacement(std::vector<Placement> &res, int x, int y, int rot, int from, Move move, int mult) {
+    int state = encode(x, y, rot);
+
+    if (placed[state]) return;
+
+    placed.set(state);
+    placeFrom[state] = from;
+    placeMove[state] = move;
+    placeMult[state] = mult;
+
+    const Shape &shape = shapes[rot];
+    Placement placement{x, y, rot, {}, state};
+
+    for (int i = 0; i < shape.numCells; ++i) {
+        placement.coords.emplace_back(x + shape.cells[i].first, y + shape.cells[i].second);
+    }
+
+    res.push_back(std::move(placement));
+}
+
+std::vector<Placement> Reachability::search() {
+    std::vector<Placement> res;
+    std::array<int, NUM_STATES> queue;
+    int head = 0, tail = 0;
+
+    visited.reset();
+    placed.reset();
+
+    // the Block does not fit where it is, so there is nothing to search
+    if (!fits(startX, startY, 0)) return res;
+
+    int start = encode(startX, startY, 0);
+    visited.set(start);
+    parent[start] = -1;
+    queue[tail++] = start;
+
+    // since the queue is in breadth-first order, the first time a resting
+    // position is found it is with the fewest commands
+    while (head < tail) {
+        int state = queue[head++];
+        int x = state % COLS;
+        int y = state / COLS % ROWS;
+        int rot = state / (COLS * ROWS);
+
+        // 'drop' from here
+        int dropY = y;
+
+        while (fits(x, dropY + 1, rot)) ++dropY;
+
+        addPlacement(res, x, dropY, rot, state, DROP, 1);
+
+        for (int m = LEFT; m < DROP; ++m) {
+            Move move = static_cast<Move>(m);
+
+            for (int mult = 1; mult <= maxMultiplier(move); ++mult) {
+                int nx = x, ny = y, nrot = rot;
+
+                if (apply(nx, ny, nrot, move, mult)) {
+                    addPlacement(res, nx, ny, nrot, state, move, mult);
+                    continue;
+                }
+
+                int next = encode(nx, ny, nrot);
+
+                if (visited[next]) continue;
+
+                visited.set(next);
+                parent[next] = state;
+                parentMove[next] = move;
+                parentMult[next] = mult;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    return res;
+}
+
+std::vector<std::string> Reachability::commandsFor(const Placement &placement) const {
+    std::vector<std::string> commands;
+    commands.push_back(commandName(placeMove[placement.state], placeMult[placement.state]));
+
+    for (int state = placeFrom[placement.state]; parent[state] != -1; state = parent[state]) {
+        commands.push_back(commandName(parentMove[state], parentMult[state]));
+    }
+
+    std::reverse(commands.begin(), commands.end());
+
+    return commands;
+}
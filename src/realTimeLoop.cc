@@ -0,0 +1,219 @@
+#include "realTimeLoop.h"
+#include "game.h"
+#include "keyboardInput.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <numeric>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static const size_t READ_SIZE = 64 * 1024;
+
+static uint32_t micros(std::chrono::steady_clock::duration d) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return us < 0 ? 0 : static_cast<uint32_t>(us);
+}
+
+static void printTimes(std::ostream &out, const char *name, std::vector<uint32_t> times) {
+    if (times.empty()) return;
+
+    std::sort(times.begin(), times.end());
+
+    uint64_t total = std::accumulate(times.begin(), times.end(), uint64_t{0});
+
+    out << name << ": mean " << total / times.size() << "us, p99 "
+        << times[(times.size() - 1) * 99 / 100] << "us, max " << times.back() << "us" << std::endl;
+}
+
+RealTimeLoop::RealTimeLoop(Game &game, int inFd, bool gravity):
+    game{game}, inFd{inFd}, timerFd{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)},
+    epollFd{epoll_create1(EPOLL_CLOEXEC)}, gravity{gravity}, keys{nullptr}, interval{0}, turn{-1},
+    missed{0} {}
+
+RealTimeLoop::~RealTimeLoop() {
+    if (timerFd != -1) close(timerFd);
+    if (epollFd != -1) close(epollFd);
+}
+
+bool RealTimeLoop::isOpen() const { return timerFd != -1 && epollFd != -1; }
+
+void RealTimeLoop::setKeyboard(KeyboardInput &keyboard) { keys = &keyboard; }
+
+int RealTimeLoop::tickInterval(int level) {
+    int highest = sizeof(TICK_MS) / sizeof(TICK_MS[0]) - 1;
+    return TICK_MS[std::clamp(level, 0, highest)];
+}
+
+void RealTimeLoop::rearm() {
+    if (!gravity) return;
+
+    int now = game.getPlayerTurn();
+    int ms = tickInterval(game.getLevel(now));
+
+    if (now == turn && ms == interval) return;
+
+    turn = now;
+    interval = ms;
+    // steady_clock is CLOCK_MONOTONIC, so the deadlines are exact and the
+    // jitter is measured against the same times the kernel uses
+    deadline = Clock::now() + std::chrono::milliseconds{ms};
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    itimerspec spec{};
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+    spec.it_interval.tv_sec = ms / 1000;
+    spec.it_interval.tv_nsec = ms % 1000 * 1000000L;
+
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+bool RealTimeLoop::onTick() {
+    uint64_t expirations;
+
+    if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) return true;
+
+    Clock::time_point woke = Clock::now();
+
+    jitters.push_back(micros(woke - deadline));
+    // ticks that expired while the loop was busy only make the Block fall once
+    missed += expirations - 1;
+    deadline += expirations * std::chrono::milliseconds{interval};
+
+    game.tick();
+    bool playing = game.step() != Game::Status::Finished;
+
+    updates.push_back(micros(Clock::now() - woke));
+
+    return playing;
+}
+
+bool RealTimeLoop::onInput(char *buf, size_t size) {
+    // only whole lines go to the Game, and what is left at the end of the input
+    if (size == 0) {
+        game.feedInput(partial.data(), partial.size());
+        partial.clear();
+        game.endInput();
+    } else {
+        char *end = buf + size;
+        char *lineEnd = end;
+
+        while (lineEnd != buf && lineEnd[-1] != '\n') --lineEnd;
+
+        if (lineEnd != buf) {
+            partial.append(buf, lineEnd);
+            game.feedInput(partial.data(), partial.size());
+            partial.clear();
+        }
+
+        partial.append(lineEnd, end);
+    }
+
+    return game.step() != Game::Status::Finished;
+}
+
+bool RealTimeLoop::onKeys() {
+    std::vector<Clock::time_point> pressed;
+    KeyboardInput::Press press;
+
+    while (keys->pop(press)) {
+        game.feed(press.command);
+        pressed.push_back(press.read);
+    }
+
+    if (pressed.empty()) return true;
+
+    // once 'step' returns the Frame showing the press was published, and the
+    // render thread takes it from there (see RenderThread::printStats)
+    bool playing = game.step() != Game::Status::Finished;
+    Clock::time_point drawn = Clock::now();
+
+    for (auto read : pressed) keyLatencies.push_back(micros(drawn - read));
+
+    return playing;
+}
+
+void RealTimeLoop::run() {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+
+    if (gravity) {
+        ev.data.fd = timerFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &ev);
+    }
+
+    if (keys) {
+        ev.data.fd = keys->fd();
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, keys->fd(), &ev);
+    }
+
+    ev.data.fd = inFd;
+
+    std::vector<char> buf(READ_SIZE);
+
+    // input that cannot be waited on (a regular file) is all there already
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, inFd, &ev) != 0) {
+        ssize_t len;
+
+        while ((len = read(inFd, buf.data(), buf.size())) > 0) game.feedInput(buf.data(), len);
+
+        game.endInput();
+    }
+
+    // shows the Boards and waits for the first command
+    if (game.step() == Game::Status::Finished) return;
+
+    rearm();
+
+    epoll_event events[3];
+
+    while (true) {
+        int n;
+
+        {
+            Trace::Span trace{"input", "input wait"};
+            n = epoll_wait(epollFd, events, 3, -1);
+        }
+
+        if (n < 0 && errno == EINTR) continue;
+        else if (n < 0) return;
+
+        for (int i = 0; i < n; ++i) {
+            bool playing;
+
+            if (events[i].data.fd == timerFd) playing = onTick();
+            else if (keys && events[i].data.fd == keys->fd()) playing = onKeys();
+            else {
+                ssize_t len = read(inFd, buf.data(), buf.size());
+
+                if (len < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                // an error ends the input the same as its end does
+                else if (len <= 0) {
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, inFd, nullptr);
+                    len = 0;
+                }
+
+                playing = onInput(buf.data(), len);
+            }
+
+            if (!playing) return;
+        }
+
+        rearm();
+    }
+}
+
+void RealTimeLoop::printStats(std::ostream &out) const {
+    if (gravity) {
+        out << "gravity ticks: " << jitters.size() << " (" << missed << " missed)" << std::endl;
+        printTimes(out, "tick jitter", jitters);
+        printTimes(out, "tick to Board update", updates);
+    }
+
+    if (keys) {
+        out << "key presses: " << keyLatencies.size() << " (" << keys->droppedPresses() << " dropped)" << std::endl;
+        printTimes(out, "key press to frame", keyLatencies);
+    }
+}
@@ -0,0 +1,84 @@
+#include "renderThread.h"
+#include "game.h"
+#include "trace.h"
+#include <algorithm>
+
+RenderThread::RenderThread(Game *game, std::vector<FrameRenderer *> renderers):
+    game{game}, renderers{std::move(renderers)}, thread{&RenderThread::run, this} {}
+
+RenderThread::~RenderThread() { stop(); }
+
+void RenderThread::notify() { publish(false); }
+
+void RenderThread::notifyWin() {
+    ++wins;
+    winner = game->getPlayerTurn();
+    publish(true);
+}
+
+void RenderThread::publish(bool won) {
+    // the slot is only the writer's until 'publish', and keeps the storage of
+    // the Frame last written to it, so no allocation is needed once warm
+    Frame &frame = frames.writeSlot();
+    frame.capture(*game);
+    frame.wins = wins;
+    frame.winner = winner;
+    frame.won = won;
+
+    ++frameCount;
+    if (frames.publish()) ++dropped;
+
+    published.fetch_add(1, std::memory_order_release);
+    published.notify_one();
+}
+
+void RenderThread::draw(const Frame &frame) {
+    Trace::Span trace{"render", "draw"};
+
+    for (auto renderer : renderers) {
+        if (!frame.won) renderer->render(frame);
+        if (frame.wins != drawnWins) renderer->renderWin(frame);
+    }
+
+    drawnWins = frame.wins;
+    ++drawn;
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Frame::Clock::now() - frame.taken).count();
+    totalLatency += latency;
+    maxLatency = std::max<uint64_t>(maxLatency, latency);
+}
+
+void RenderThread::run() {
+    uint64_t seen = 0;
+
+    Trace::nameThread("render");
+
+    while (true) {
+        published.wait(seen, std::memory_order_acquire);
+        seen = published.load(std::memory_order_acquire);
+
+        // read before taking the Frame, so the last one is drawn before ending
+        bool last = stopping.load(std::memory_order_acquire);
+
+        if (frames.take()) draw(frames.readSlot());
+
+        if (last) return;
+    }
+}
+
+void RenderThread::stop() {
+    if (!thread.joinable()) return;
+
+    stopping.store(true, std::memory_order_release);
+    published.fetch_add(1, std::memory_order_release);
+    published.notify_one();
+    thread.join();
+}
+
+void RenderThread::printStats(std::ostream &out) const {
+    out << "frames: " << frameCount << " published, " << drawn << " drawn, " << dropped << " dropped" << std::endl;
+
+    if (drawn > 0) {
+        out << "frame to pixels: mean " << totalLatency / drawn << "us, max " << maxLatency << "us" << std::endl;
+    }
+}
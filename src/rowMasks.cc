@@ -0,0 +1,3 @@
+#include "rowMasks.h"
+
+int clearFullRows(RowMasks &rows) { return clearFullRows<MASK_ROWS, MASK_COLS>(rows); }
@@ -0,0 +1,207 @@
+#include "script.h"
+#include "commandInterpreter.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// Compiled scripts are only a cache of this program on this machine, so they
+// are written in the machine's own byte order. The version is part of the magic
+// and must change whenever ScriptOp, the layout below or which lines are errors does.
+static const char BQC_MAGIC[8] = {'B', 'Q', 'C', 'S', 'C', 'R', '0', '3'};
+
+static uint64_t fnv1a(const std::string &s, uint64_t hash = 0xCBF29CE484222325ULL) {
+    for (unsigned char c : s) hash = (hash ^ c) * 0x100000001B3ULL;
+
+    return hash;
+}
+
+template<typename T> static void writeRaw(std::ostream &out, T value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void writeString(std::ostream &out, const std::string &s) {
+    writeRaw<uint32_t>(out, s.size());
+    out.write(s.data(), s.size());
+}
+
+template<typename T> static bool readRaw(std::istream &in, T &value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+static bool readString(std::istream &in, std::string &s) {
+    uint32_t size;
+
+    if (!readRaw(in, size)) return false;
+
+    s.resize(size);
+
+    return static_cast<bool>(in.read(s.data(), size));
+}
+
+Script::Script(const std::string &file, const CommandInterpreter &ci): file{file}, next{0}, opened{false} {
+    std::ifstream f{file, std::ios::binary};
+
+    if (!f.is_open()) return;
+
+    opened = true;
+
+    std::ostringstream contents;
+    contents << f.rdbuf();
+    const std::string text = contents.str();
+
+    // the ops depend on the commands as much as on the file, since a rename or
+    // a macro changes what the lines mean
+    const uint64_t key = fnv1a(text, ci.commandsHash());
+    const std::string compiled = file + ".bqc";
+    std::vector<std::string> lineErrors;
+
+    if (!loadCompiled(compiled, key, lineErrors)) {
+        compile(text, ci, lineErrors);
+        saveCompiled(compiled, key, lineErrors);
+    }
+
+    for (const auto &error : lineErrors) errors.push_back(file + ":" + error);
+}
+
+void Script::compile(const std::string &text, const CommandInterpreter &ci, std::vector<std::string> &lineErrors) {
+    // split the same way std::getline does, so there is no empty last line
+    // after a final newline
+    size_t start = 0;
+    bool changed = false;
+
+    ops.clear();
+
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+
+        if (end == std::string::npos) end = text.size();
+
+        std::string error;
+        ops.push_back(ci.compileLine(text.substr(start, end - start), ops.size() + 1, error));
+
+        // the lines after a rename or a macro may not name the same commands,
+        // so they can only be checked when they run
+        if (changed) ops.back().kind = ScriptOp::Kind::Raw;
+        else if (!error.empty()) lineErrors.push_back(error);
+
+        changed = changed || ops.back().changesCommands;
+
+        start = end + 1;
+    }
+}
+
+bool Script::loadCompiled(const std::string &compiled, uint64_t key, std::vector<std::string> &lineErrors) {
+    std::ifstream in{compiled, std::ios::binary};
+    char magic[sizeof(BQC_MAGIC)];
+    uint64_t storedKey;
+    uint32_t numOps, numErrors;
+
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), BQC_MAGIC) ||
+        !readRaw(in, storedKey) || storedKey != key || !readRaw(in, numOps)) {
+        return false;
+    }
+
+    std::vector<ScriptOp> loaded(numOps);
+
+    for (auto &op : loaded) {
+        uint8_t kind, hasFilename, changesCommands;
+        int32_t line, target;
+        uint32_t numCommands;
+
+        if (!readRaw(in, kind) || !readRaw(in, hasFilename) || !readRaw(in, changesCommands) ||
+            !readRaw(in, line) || !readString(in, op.text) || !readRaw(in, numCommands)) {
+            return false;
+        }
+
+        op.commands.resize(numCommands);
+
+        for (auto &command : op.commands) {
+            int32_t multiplier;
+
+            if (!readString(in, command.name) || !readRaw(in, multiplier)) return false;
+
+            command.multiplier = multiplier;
+        }
+
+        if (!readString(in, op.specAct) || !readRaw(in, target) || !readString(in, op.filename) ||
+            !readString(in, op.message)) {
+            return false;
+        }
+
+        op.kind = kind ? ScriptOp::Kind::Raw : ScriptOp::Kind::Resolved;
+        op.line = line;
+        op.target = target;
+        op.hasFilename = hasFilename;
+        op.changesCommands = changesCommands;
+    }
+
+    if (!readRaw(in, numErrors)) return false;
+
+    std::vector<std::string> loadedErrors(numErrors);
+
+    for (auto &error : loadedErrors) {
+        if (!readString(in, error)) return false;
+    }
+
+    ops = std::move(loaded);
+    lineErrors = std::move(loadedErrors);
+
+    return true;
+}
+
+void Script::saveCompiled(const std::string &compiled, uint64_t key, const std::vector<std::string> &lineErrors) const {
+    // written to a temporary file first, so a run reading the cache at the same
+    // time never sees half of it
+    const std::string tmp = compiled + ".tmp";
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+
+    // the cache is only an optimization, e.g. the directory may be read-only
+    if (!out.is_open()) return;
+
+    out.write(BQC_MAGIC, sizeof(BQC_MAGIC));
+    writeRaw<uint64_t>(out, key);
+    writeRaw<uint32_t>(out, ops.size());
+
+    for (const auto &op : ops) {
+        writeRaw<uint8_t>(out, op.kind == ScriptOp::Kind::Raw);
+        writeRaw<uint8_t>(out, op.hasFilename);
+        writeRaw<uint8_t>(out, op.changesCommands);
+        writeRaw<int32_t>(out, op.line);
+        writeString(out, op.text);
+        writeRaw<uint32_t>(out, op.commands.size());
+
+        for (const auto &command : op.commands) {
+            writeString(out, command.name);
+            writeRaw<int32_t>(out, command.multiplier);
+        }
+
+        writeString(out, op.specAct);
+        writeRaw<int32_t>(out, op.target);
+        writeString(out, op.filename);
+        writeString(out, op.message);
+    }
+
+    writeRaw<uint32_t>(out, lineErrors.size());
+
+    for (const auto &error : lineErrors) writeString(out, error);
+
+    out.close();
+
+    if (!out || std::rename(tmp.c_str(), compiled.c_str()) != 0) std::remove(tmp.c_str());
+}
+
+bool Script::isOpen() const { return opened; }
+
+const std::string &Script::getFile() const { return file; }
+
+const std::vector<std::string> &Script::getErrors() const { return errors; }
+
+const ScriptOp *Script::nextOp() {
+    if (next >= ops.size()) return nullptr;
+
+    return &ops[next++];
+}
+
+void Script::abort() { next = ops.size(); }
@@ -1,71 +1,81 @@
 #include "textObserver.h"
+#include "profile.h"
 #include <iostream>
 using namespace std;
 
-TextObserver::TextObserver(Game *game):game{game}{}
+TextObserver::TextObserver(Game *game, std::ostream &out): out{out}, game{game}{}
 
 void TextObserver::notify() {
+    frame.capture(*game);
+    render(frame);
+}
+
+void TextObserver::notifyWin() {
+    frame.capture(*game);
+    frame.winner = frame.turn;
+    renderWin(frame);
+}
+
+void TextObserver::render(const Frame &frame) {
+    Profile::Scope profile{Profile::TextRender};
+    int numPlayers = frame.numPlayers;
+
     // Header
     out << "         BIQUADRIS" << endl;
-    out << "HISCORE: " << game->getHiScore() << "   TURN: PLAYER " << (game->getPlayerTurn())+1 << endl;
+    out << "HISCORE: " << frame.hiScore << "   TURN: PLAYER " << frame.turn + 1 << endl;
     out << endl;
-    out << "LEVEL:    " << game->getLevel(P0_IDX) << "     "
-        << "LEVEL:    " << game->getLevel(P1_IDX) << endl;
-    out << "SCORE:    " << game->getScore(P0_IDX) << "     "
-        << "SCORE:    " << game->getScore(P1_IDX) << endl;
-    out << "-----------     -----------" << endl;
+    for (int p = 0; p < numPlayers; ++p) {
+        if (p > 0) out << BOARD_GAP;
+        out << "LEVEL:    " << frame.levels[p];
+    }
+    out << endl;
+    for (int p = 0; p < numPlayers; ++p) {
+        if (p > 0) out << BOARD_GAP;
+        out << "SCORE:    " << frame.scores[p];
+    }
+    out << endl;
+    printBorder(frame);
     
-    print();
+    print(frame);
 
     // Footer
-    out << "-----------     -----------" << endl;
-    out << "NEXT:      " << "     "
-        << "NEXT:      " << endl;
-    for (int i = 2; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            bool found = false;
-            // If the following does not find, print " "
-            for (int k = 0; k < 4; ++k) {
-                if (((game->getNextBlock(P0_IDX))->getCoords())[k].first == j && ((game->getNextBlock(P0_IDX))->getCoords())[k].second == i) {
-                    out << (game->getNextBlock(P0_IDX))->getBlockSymbol();
-                    found = true;
-                }
-            }
-            if (!found) out << " ";
-        }
-        out << "            ";
-        for (int j = 0; j < 4; ++j) {
-            bool found = false;
-            // If the following does not find, print " "
-            for (int k = 0; k < 4; ++k) {
-                if (((game->getNextBlock(P1_IDX))->getCoords())[k].first == j && ((game->getNextBlock(P1_IDX))->getCoords())[k].second == i) {
-                    out << (game->getNextBlock(P1_IDX))->getBlockSymbol();
-                    found = true;
-                }
+    printBorder(frame);
+    for (int p = 0; p < numPlayers; ++p) {
+        if (p > 0) out << BOARD_GAP;
+        out << "NEXT:      ";
+    }
+    out << endl;
+    for (int i = Frame::NEXT_TOP; i < Frame::NEXT_TOP + Frame::NEXT_ROWS; ++i) {
+        for (int p = 0; p < numPlayers; ++p) {
+            if (p > 0) out << "       " << BOARD_GAP;
+            for (int j = 0; j < Frame::NEXT_COLS; ++j) {
+                out << frame.nextCell(p, i, j);
             }
-            if (!found) out << " ";
         }
         out << "       " << endl;
     }
 }
 
-void TextObserver::notifyWin() {
-    out << "Player " << game->getPlayerTurn() + 1 << " has won!\n";
+void TextObserver::renderWin(const Frame &frame) {
+    out << "Player " << frame.winner + 1 << " has won!\n";
     out << "Enter 'restart' to restart the game.\n";
 }
 
-void TextObserver::print() {
+void TextObserver::printBorder(const Frame &frame) {
+    for (int p = 0; p < frame.numPlayers; ++p) {
+        if (p > 0) out << BOARD_GAP;
+        out << std::string(COLS, '-');
+    }
+    out << endl;
+}
+
+void TextObserver::print(const Frame &frame) {
+    // Blind Boards already give '?' for their hidden Tiles
     for (int i = 0; i < ROWS; ++i) {
-        for (int j = 0; j < COLS; ++j) {
-            out << game->getState(P0_IDX, i, j); // State of p1
-        }
-        out << "     ";
-        for (int j = 0; j < COLS; ++j) {
-            if (j >= BLINDL && j <= BLINDR && i >= BLINDT && i <= BLINDB && game->isBoardBlind(P1_IDX)) {
-                out << '?';
-            }
-            else {
-                out << game->getState(P1_IDX, i, j); // State of p2
+        for (int p = 0; p < frame.numPlayers; ++p) {
+            if (p > 0) out << BOARD_GAP;
+            for (int j = 0; j < COLS; ++j) {
+                out << frame.cell(p, i, j);
             }
         }
         out << endl;
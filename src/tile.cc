@@ -1,7 +1,8 @@
 #include "tile.h"
+#include <utility>
 
 // Constructor for Tile
-Tile::Tile(char symbol, bool isOccupied, std::shared_ptr<Block> parent)
-    :symbol{symbol},isOccupied{isOccupied},parent{parent}{}
+Tile::Tile(char symbol, bool isOccupied, BlockRef parent)
+    :symbol{symbol},isOccupied{isOccupied},parent{std::move(parent)}{}
 char Tile::getSymbol() const { return symbol; }
 bool Tile::getIsOccupied() const { return isOccupied; }
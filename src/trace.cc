@@ -0,0 +1,143 @@
+#include "trace.h"
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    // times in nanoseconds since the trace started
+    struct Event {
+        const char *category;
+        const char *name;
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    // filled by its thread only, 'used' telling the writer how much of it is
+    struct Chunk {
+        static constexpr size_t SIZE = 4096;
+
+        Event events[SIZE];
+        std::atomic<size_t> used{0};
+    };
+
+    struct Track {
+        // from 1, in the order the threads first recorded
+        int tid;
+        const char *name;
+        // only grown with 'tracksMutex' held, 'current' is the last of them
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        Chunk *current = nullptr;
+    };
+
+    // a thread stops recording once it has this many Chunks (32MB), so
+    // a long game cannot use up the memory
+    const size_t MAX_CHUNKS = 256;
+
+    Trace::Clock::time_point origin;
+    std::mutex tracksMutex;
+    // never freed, so a thread ending leaves its spans in the trace
+    std::vector<std::unique_ptr<Track>> tracks;
+    thread_local Track *ownTrack = nullptr;
+
+    Track &track() {
+        if (!ownTrack) {
+            std::lock_guard<std::mutex> lock{tracksMutex};
+
+            tracks.push_back(std::make_unique<Track>());
+            ownTrack = tracks.back().get();
+            ownTrack->tid = tracks.size();
+            ownTrack->name = "thread";
+        }
+
+        return *ownTrack;
+    }
+
+    uint64_t since(Trace::Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+    }
+
+    // trace-event times are in microseconds, kept to the nanosecond
+    void putMicros(std::ostream &out, uint64_t nanos) {
+        out << nanos / 1000 << '.' << std::setw(3) << std::setfill('0') << nanos % 1000;
+    }
+}
+
+std::atomic<bool> Trace::enabled{false};
+
+void Trace::enable() {
+    origin = Clock::now();
+    enabled.store(true, std::memory_order_relaxed);
+    nameThread("game");
+}
+
+void Trace::nameThread(const char *name) {
+    if (!isEnabled()) return;
+
+    Track &t = track();
+    std::lock_guard<std::mutex> lock{tracksMutex};
+    t.name = name;
+}
+
+void Trace::record(const char *category, const char *name, Clock::time_point start, Clock::time_point end) {
+    Track &t = track();
+    Chunk *chunk = t.current;
+    size_t used = chunk ? chunk->used.load(std::memory_order_relaxed) : Chunk::SIZE;
+
+    if (used == Chunk::SIZE) {
+        if (t.chunks.size() == MAX_CHUNKS) return;
+
+        // allocated before taking the lock, which the writer may be holding
+        auto fresh = std::make_unique<Chunk>();
+        chunk = fresh.get();
+        used = 0;
+
+        std::lock_guard<std::mutex> lock{tracksMutex};
+        t.chunks.push_back(std::move(fresh));
+        t.current = chunk;
+    }
+
+    chunk->events[used] = {category, name, since(start), since(end) - since(start)};
+    chunk->used.store(used + 1, std::memory_order_release);
+}
+
+bool Trace::write(const std::string &path) {
+    std::ofstream out{path};
+
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock{tracksMutex};
+    int pid = getpid();
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"biquadris\"}}";
+
+    for (auto &t : tracks) {
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << t->tid
+            << ",\"args\":{\"name\":\"" << t->name << "\"}}";
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":" << pid << ",\"tid\":" << t->tid
+            << ",\"args\":{\"sort_index\":" << t->tid << "}}";
+
+        for (auto &chunk : t->chunks) {
+            size_t used = chunk->used.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < used; ++i) {
+                const Event &e = chunk->events[i];
+
+                out << ",\n{\"ph\":\"X\",\"cat\":\"" << e.category << "\",\"name\":\"" << e.name
+                    << "\",\"pid\":" << pid << ",\"tid\":" << t->tid << ",\"ts\":";
+                putMicros(out, e.start);
+                out << ",\"dur\":";
+                putMicros(out, e.duration);
+                out << '}';
+            }
+        }
+    }
+
+    out << "\n]}\n";
+
+    return static_cast<bool>(out.flush());
+}
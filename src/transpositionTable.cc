@@ -0,0 +1,118 @@
+#include "transpositionTable.h"
+
+double TranspositionTable::Stats::hitRate() const {
+    return probes ? static_cast<double>(hits) / probes : 0.0;
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes, Replace policy):
+    policy{policy}, probes{0}, hits{0}, stores{0}, overwrites{0} {
+    size_t numBuckets = 1;
+
+    while (numBuckets * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) numBuckets *= 2;
+
+    buckets = std::make_unique<Bucket[]>(numBuckets);
+    if (policy == Replace::Newest) cursors = std::make_unique<std::atomic<uint8_t>[]>(numBuckets);
+    mask = numBuckets - 1;
+    clear();
+}
+
+uint64_t TranspositionTable::positionKey(uint64_t boardHash, char current, char next) {
+    // spread the two Blocks over the whole key, so they do not cancel out with
+    // the bits of the Board's hash
+    uint64_t z = (static_cast<uint64_t>(static_cast<unsigned char>(current)) << 8 |
+                  static_cast<unsigned char>(next)) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return boardHash ^ z ^ (z >> 31);
+}
+
+TranspositionTable::Bucket &TranspositionTable::bucketFor(uint64_t key) const {
+    return buckets[key & mask];
+}
+
+int TranspositionTable::depthOf(uint64_t data) { return static_cast<int>(data >> VALUE_BITS) - 1; }
+
+bool TranspositionTable::probe(uint64_t key, uint64_t &value, int &depth) {
+    probes.fetch_add(1, std::memory_order_relaxed);
+
+    for (auto &entry : bucketFor(key).entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+        // an empty entry, or one that belongs to another key or that was being
+        // overwritten while we read it
+        if (data == 0 || (check ^ data) != key) continue;
+
+        value = data & VALUE_MASK;
+        depth = depthOf(data);
+        hits.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, uint64_t value, int depth) {
+    Bucket &bucket = bucketFor(key);
+    uint64_t data = (static_cast<uint64_t>(depth + 1) << VALUE_BITS) | (value & VALUE_MASK);
+    Entry *victim = nullptr;
+
+    stores.fetch_add(1, std::memory_order_relaxed);
+
+    // the same position is always overwritten in place, then an empty entry
+    // is used if there is one
+    for (auto &entry : bucket.entries) {
+        uint64_t old = entry.data.load(std::memory_order_relaxed);
+
+        if (old != 0 && (entry.check.load(std::memory_order_relaxed) ^ old) == key) {
+            victim = &entry;
+            break;
+        } else if (old == 0 && !victim) {
+            victim = &entry;
+        }
+    }
+
+    if (!victim) {
+        overwrites.fetch_add(1, std::memory_order_relaxed);
+
+        if (policy == Replace::Newest) {
+            // two threads racing here may pick the same entry, which only
+            // means one of their results is not kept
+            uint8_t next = cursors[key & mask].fetch_add(1, std::memory_order_relaxed);
+            victim = &bucket.entries[next % ENTRIES_PER_BUCKET];
+        } else {
+            victim = &bucket.entries[0];
+
+            for (auto &entry : bucket.entries) {
+                if (depthOf(entry.data.load(std::memory_order_relaxed)) <
+                    depthOf(victim->data.load(std::memory_order_relaxed))) {
+                    victim = &entry;
+                }
+            }
+        }
+    }
+
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        for (auto &entry : buckets[i].entries) {
+            entry.data.store(0, std::memory_order_relaxed);
+            entry.check.store(0, std::memory_order_relaxed);
+        }
+
+        if (cursors) cursors[i].store(0, std::memory_order_relaxed);
+    }
+
+    probes = hits = stores = overwrites = 0;
+}
+
+TranspositionTable::Stats TranspositionTable::stats() const {
+    return {probes.load(), hits.load(), stores.load(), overwrites.load()};
+}
+
+size_t TranspositionTable::capacity() const { return (mask + 1) * ENTRIES_PER_BUCKET; }
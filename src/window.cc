@@ -10,6 +10,10 @@ using namespace std;
 
 Xwindow::Xwindow(int width, int height) : width{width}, height{height} {
 
+  // the keyboard's thread talks to the X server at the same time as this one,
+  // which Xlib only allows once told so, before anything else
+  XInitThreads();
+
   d = XOpenDisplay(NULL);
   if (d == NULL) {
     cerr << "Cannot open display" << endl;
@@ -62,6 +66,7 @@ Xwindow::~Xwindow() {
 
 int Xwindow::getWidth() const { return width; }
 int Xwindow::getHeight() const { return height; }
+unsigned long Xwindow::getWindow() const { return w; }
 
 void Xwindow::fillRectangle(int x, int y, int width, int height, int colour) {
   XSetForeground(d, gc, colours[colour]);
@@ -0,0 +1,43 @@
+#include "zobrist.h"
+#include <bit>
+
+template<int Rows, int Cols>
+const typename BasicZobrist<Rows, Cols>::Table &BasicZobrist<Rows, Cols>::table() {
+    // filled on first use with splitmix64, which is enough to spread the keys
+    static const Table keys = [] {
+        Table res;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+        for (auto &row : res) {
+            for (auto &k : row) {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                k = z ^ (z >> 31);
+            }
+        }
+
+        return res;
+    }();
+
+    return keys;
+}
+
+template<int Rows, int Cols>
+uint64_t BasicZobrist<Rows, Cols>::key(int row, int col) { return table()[row][col]; }
+
+template<int Rows, int Cols>
+uint64_t BasicZobrist<Rows, Cols>::hash(const BasicRowMasks<Rows> &rows) {
+    const Table &keys = table();
+    uint64_t res = 0;
+
+    for (int i = 0; i < ROWS; ++i) {
+        // only the occupied columns, lowest first
+        for (unsigned bits = rows[i]; bits; bits &= bits - 1) res ^= keys[i][std::countr_zero(bits)];
+    }
+
+    return res;
+}
+
+template class BasicZobrist<StandardDims::ROWS, StandardDims::COLS>;
+template class BasicZobrist<WideDims::ROWS, WideDims::COLS>;